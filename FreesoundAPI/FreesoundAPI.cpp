@@ -1,5 +1,11 @@
 #include "FreesoundAPI.h"
 
+#if JUCE_LINUX && defined(__GLIBC__)
+ #include <malloc.h>
+#elif JUCE_MAC
+ #include <malloc/malloc.h>
+#endif
+
 String URIS::HOST = String("freesound.org");
 String URIS::BASE = String("https://" + HOST + "/apiv2");
 String URIS::TEXT_SEARCH = String("/search/text/");
@@ -122,8 +128,8 @@ void FreesoundClient::refreshAccessToken(Callback cb) {
 	cb();
 }
 
-// https://freesound.org/docs/api/resources_apiv2.html#text-search
-SoundList FreesoundClient::textSearch(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
+//Parameters shared by the text search calls
+static StringPairArray makeTextSearchParams(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
 {
 	StringPairArray params;
 	params.set("query", query);
@@ -154,18 +160,160 @@ SoundList FreesoundClient::textSearch(String query, String filter, String sort,
 		params.set("normalized", "1");
 	}
 
+	return params;
+}
+
+// https://freesound.org/docs/api/resources_apiv2.html#text-search
+SoundList FreesoundClient::textSearch(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	StringPairArray params = makeTextSearchParams(query, filter, sort, groupByPack, page, pageSize, fields, descriptors, normalized);
+
 	URL url = URIS::uri(URIS::TEXT_SEARCH, StringArray());
 	FSRequest request(url, *this);
-	Response resp = request.request(params,String(),false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, params, String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
 }
 
+FSSoundTable FreesoundClient::textSearchAsTable(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	StringPairArray params = makeTextSearchParams(query, filter, sort, groupByPack, page, pageSize, fields, descriptors, normalized);
+
+	URL url = URIS::uri(URIS::TEXT_SEARCH, StringArray());
+	FSRequest request(url, *this);
+	FSSoundTable returnedSounds;
+	int resultCode = request.requestSoundTable(returnedSounds, params, String(), false);
+	if (resultCode == 200) {
+		return returnedSounds;
+	}
+	return FSSoundTable();
+}
+
+namespace
+{
+	//One page of a sample, fetched on a thread of its own. The caller may itself
+	//be a request pool job, and waiting on the pool from inside one could deadlock it.
+	class SamplePageFetch : public Thread
+	{
+	public:
+		SamplePageFetch(const FreesoundClient& clientToUse, const StringPairArray& paramsToUse)
+			: Thread("Freesound sample page"), client(clientToUse), params(paramsToUse) {}
+
+		~SamplePageFetch() override
+		{
+			token.cancel();
+			stopThread(-1);
+		}
+
+		void run() override
+		{
+			FSCancellationToken::ScopedCurrent current(token);
+			FSRequest request(URIS::uri(URIS::TEXT_SEARCH, StringArray()), client);
+			statusCode = request.requestSoundTable(result, params, String(), false);
+		}
+
+		FSCancellationToken token;
+		FSSoundTable result;
+		int statusCode = -1;
+
+	private:
+		FreesoundClient client;
+		StringPairArray params;
+	};
+}
+
+FSSoundTable FreesoundClient::textSearchSample(String query, int numSounds, int64 seed, String filter, String sort, int groupByPack, String fields)
+{
+	if (numSounds <= 0) { return FSSoundTable(); }
+
+	//A single result, with nothing but its ID, to learn how many there are
+	FSRequest countRequest(URIS::uri(URIS::TEXT_SEARCH, StringArray()), *this);
+	FSSoundTable first;
+	StringPairArray countParams = makeTextSearchParams(query, filter, sort, groupByPack, 1, 1, "id", String(), 0);
+
+	if (countRequest.requestSoundTable(first, countParams, String(), false) != 200) { return FSSoundTable(); }
+
+	const int count = first.getTotalCount();
+	if (count <= 0) { return FSSoundTable(); }
+
+	//juce::Random rather than the standard distributions, whose results differ
+	//between standard libraries, so a seed picks the same sounds everywhere
+	Random random(seed);
+
+	//A few small pages rather than one big one, so the picks are spread over all
+	//the results and not just the best scored
+	int numPages = jmax(jmin(maxSamplePages, numSounds), (numSounds + maxPageSize - 1) / maxPageSize);
+	const int pageSize = jlimit(1, maxPageSize, (numSounds + numPages - 1) / numPages);
+	const int totalPages = (count + pageSize - 1) / pageSize;
+	numPages = jmin(numPages, totalPages);
+
+	//Cancelling the asynchronous call this runs in cancels every page
+	FSCancellationToken* token = FSCancellationToken::getCurrent();
+
+	//Results can move between requests, so a sound may turn up on two pages.
+	//The last page is short and pages can fail, so more are fetched until
+	//there are enough sounds or no pages left.
+	FSSoundTable candidates;
+	Array<int> usedPages;
+
+	while (candidates.size() < numSounds && usedPages.size() < totalPages) {
+		if (!usedPages.isEmpty()) {
+			const int missing = numSounds - candidates.size();
+			numPages = jmin(maxSamplePages, (missing + pageSize - 1) / pageSize);
+		}
+		numPages = jmin(numPages, totalPages - usedPages.size());
+
+		OwnedArray<SamplePageFetch> fetches;
+		while (fetches.size() < numPages) {
+			const int page = random.nextInt(totalPages) + 1;
+			if (usedPages.contains(page)) { continue; }
+
+			usedPages.add(page);
+			fetches.add(new SamplePageFetch(*this, makeTextSearchParams(query, filter, sort, groupByPack, page, pageSize, fields, String(), 0)));
+		}
+
+		for (auto* fetch : fetches) { fetch->startThread(); }
+
+		for (auto* fetch : fetches) {
+			while (!fetch->waitForThreadToExit(50)) {
+				if (token != nullptr && token->isCancelled()) {
+					for (auto* other : fetches) { other->token.cancel(); }
+				}
+			}
+		}
+
+		if (token != nullptr && token->isCancelled()) { return FSSoundTable(); }
+
+		bool anyFetched = false;
+		for (auto* fetch : fetches) {
+			if (fetch->statusCode != 200) { continue; }
+			anyFetched = true;
+
+			for (int i = 0; i < fetch->result.size(); ++i) {
+				const FSSoundTable::Row row = fetch->result[i];
+				if (candidates.indexOf(row.getId()) < 0) { candidates.add(row); }
+			}
+		}
+
+		//Every page failing means the server or the connection is down
+		if (!anyFetched) { break; }
+	}
+
+	Array<int> order;
+	for (int i = 0; i < candidates.size(); ++i) { order.add(i); }
+	for (int i = order.size() - 1; i > 0; --i) { order.swap(i, random.nextInt(i + 1)); }
+	order.resize(jmin(numSounds, order.size()));
+
+	FSSoundTable sample;
+	sample.reserve(order.size());
+	for (int index : order) { sample.add(candidates[index]); }
+
+	return sample;
+}
+
 SoundList FreesoundClient::contentSearch(String target, String descriptorsFilter, int page, int pageSize, String fields, String descriptors, int normalized)
 {
 	StringPairArray params;
@@ -198,11 +346,9 @@ SoundList FreesoundClient::contentSearch(String target, String descriptorsFilter
 
 	URL url = URIS::uri(URIS::CONTENT_SEARCH, StringArray());
 	FSRequest request(url, *this);
-	Response resp = request.request(params, String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, params, String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -237,11 +383,9 @@ FSList FreesoundClient::fetchPreviousPage(FSList soundList)
 SoundList FreesoundClient::fetchNextPage(SoundList soundList)
 {
 	FSRequest request(soundList.getNextPage(), *this);
-	Response resp = request.request(StringPairArray(), String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, StringPairArray(), String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -250,11 +394,9 @@ SoundList FreesoundClient::fetchNextPage(SoundList soundList)
 SoundList FreesoundClient::fetchPreviousPage(SoundList soundList)
 {
 	FSRequest request(soundList.getPreviousPage(), *this);
-	Response resp = request.request(StringPairArray(), String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, StringPairArray(), String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -333,11 +475,9 @@ SoundList FreesoundClient::getSimilarSounds(String id, String descriptorsFilter,
 
 	URL url = URIS::uri(URIS::SIMILAR_SOUNDS, id);
 	FSRequest request(url, *this);
-	Response resp = request.request(params, String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, params, String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -571,11 +711,9 @@ SoundList FreesoundClient::getUserSounds(String username, String descriptorsFilt
 
 	URL url = URIS::uri(URIS::USER_SOUNDS, username);
 	FSRequest request(url, *this);
-	Response resp = request.request(params, String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, params, String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -671,11 +809,9 @@ SoundList FreesoundClient::getPackSounds(String id, String descriptorsFilter, in
 
 	URL url = URIS::uri(URIS::PACK_SOUNDS, StringArray(id));
 	FSRequest request(url, *this);
-	Response resp = request.request(params, String(), false);
-	int resultCode = resp.first;
+	SoundList returnedSounds;
+	int resultCode = request.requestSounds(returnedSounds, params, String(), false);
 	if (resultCode == 200) {
-		var response = resp.second;
-		SoundList returnedSounds(response);
 		return returnedSounds;
 	}
 	return SoundList();
@@ -726,6 +862,483 @@ String FreesoundClient::getClientID()
 	return clientID;
 }
 
+ThreadPool& FreesoundClient::getRequestPool()
+{
+	return *FSRequestPool::getInstance();
+}
+
+FSFuture<SoundList> FreesoundClient::textSearchAsync(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.textSearch(query, filter, sort, groupByPack, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<FSSoundTable> FreesoundClient::textSearchAsTableAsync(String query, String filter, String sort, int groupByPack, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<FSSoundTable>([=](FreesoundClient& client) { return client.textSearchAsTable(query, filter, sort, groupByPack, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<FSSoundTable> FreesoundClient::textSearchSampleAsync(String query, int numSounds, int64 seed, String filter, String sort, int groupByPack, String fields)
+{
+	return runAsync<FSSoundTable>([=](FreesoundClient& client) { return client.textSearchSample(query, numSounds, seed, filter, sort, groupByPack, fields); });
+}
+
+FSFuture<SoundList> FreesoundClient::contentSearchAsync(String target, String descriptorsFilter, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.contentSearch(target, descriptorsFilter, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<FSList> FreesoundClient::fetchNextPageAsync(FSList fslist)
+{
+	return runAsync<FSList>([=](FreesoundClient& client) { return client.fetchNextPage(fslist); });
+}
+
+FSFuture<FSList> FreesoundClient::fetchPreviousPageAsync(FSList fslist)
+{
+	return runAsync<FSList>([=](FreesoundClient& client) { return client.fetchPreviousPage(fslist); });
+}
+
+FSFuture<SoundList> FreesoundClient::fetchNextPageAsync(SoundList fslist)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.fetchNextPage(fslist); });
+}
+
+FSFuture<SoundList> FreesoundClient::fetchPreviousPageAsync(SoundList fslist)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.fetchPreviousPage(fslist); });
+}
+
+FSFuture<FSSound> FreesoundClient::getSoundAsync(String id, String fields)
+{
+	return runAsync<FSSound>([=](FreesoundClient& client) { return client.getSound(id, fields); });
+}
+
+FSFuture<var> FreesoundClient::getSoundAnalysisAsync(String id, String descriptors, int normalized)
+{
+	return runAsync<var>([=](FreesoundClient& client) { return client.getSoundAnalysis(id, descriptors, normalized); });
+}
+
+FSFuture<SoundList> FreesoundClient::getSimilarSoundsAsync(String id, String descriptorsFilter, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.getSimilarSounds(id, descriptorsFilter, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<int> FreesoundClient::uploadSoundAsync(const File & fileToUpload, String tags, String description, String name, String license, String pack, String geotag)
+{
+	return runAsync<int>([=](FreesoundClient& client) { return client.uploadSound(fileToUpload, tags, description, name, license, pack, geotag); });
+}
+
+FSFuture<int> FreesoundClient::describeSoundAsync(String uploadFilename, String description, String license, String name, String tags, String pack, String geotag)
+{
+	return runAsync<int>([=](FreesoundClient& client) { return client.describeSound(uploadFilename, description, license, name, tags, pack, geotag); });
+}
+
+FSFuture<var> FreesoundClient::pendingUploadsAsync()
+{
+	return runAsync<var>([](FreesoundClient& client) { return client.pendingUploads(); });
+}
+
+FSFuture<bool> FreesoundClient::editSoundDescriptionAsync(String id, String name, String tags, String description, String license, String pack, String geotag)
+{
+	return runAsync<bool>([=](FreesoundClient& client) { client.editSoundDescription(id, name, tags, description, license, pack, geotag); return true; });
+}
+
+FSFuture<bool> FreesoundClient::bookmarkSoundAsync(String id, String name, String category)
+{
+	return runAsync<bool>([=](FreesoundClient& client) { client.bookmarkSound(id, name, category); return true; });
+}
+
+FSFuture<bool> FreesoundClient::rateSoundAsync(String id, int rating)
+{
+	return runAsync<bool>([=](FreesoundClient& client) { client.rateSound(id, rating); return true; });
+}
+
+FSFuture<bool> FreesoundClient::commentSoundAsync(String id, String comment)
+{
+	return runAsync<bool>([=](FreesoundClient& client) { client.commentSound(id, comment); return true; });
+}
+
+FSFuture<FSUser> FreesoundClient::getUserAsync(String user)
+{
+	return runAsync<FSUser>([=](FreesoundClient& client) { return client.getUser(user); });
+}
+
+FSFuture<SoundList> FreesoundClient::getUserSoundsAsync(String username, String descriptorsFilter, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.getUserSounds(username, descriptorsFilter, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<FSList> FreesoundClient::getUserBookmarkCategoriesAsync(String username)
+{
+	return runAsync<FSList>([=](FreesoundClient& client) { return client.getUserBookmarkCategories(username); });
+}
+
+FSFuture<FSList> FreesoundClient::getUserBookmarkCategoriesSoundsAsync(String username, String bookmarkCategory)
+{
+	return runAsync<FSList>([=](FreesoundClient& client) { return client.getUserBookmarkCategoriesSounds(username, bookmarkCategory); });
+}
+
+FSFuture<FSList> FreesoundClient::getUserPacksAsync(String username)
+{
+	return runAsync<FSList>([=](FreesoundClient& client) { return client.getUserPacks(username); });
+}
+
+FSFuture<FSPack> FreesoundClient::getPackAsync(String id)
+{
+	return runAsync<FSPack>([=](FreesoundClient& client) { return client.getPack(id); });
+}
+
+FSFuture<SoundList> FreesoundClient::getPackSoundsAsync(String id, String descriptorsFilter, int page, int pageSize, String fields, String descriptors, int normalized)
+{
+	return runAsync<SoundList>([=](FreesoundClient& client) { return client.getPackSounds(id, descriptorsFilter, page, pageSize, fields, descriptors, normalized); });
+}
+
+FSFuture<FSUser> FreesoundClient::getMeAsync()
+{
+	return runAsync<FSUser>([](FreesoundClient& client) { return client.getMe(); });
+}
+
+String FreesoundClient::benchmarkSoundListDecoding(String query, String filter, String fields, int pageSize)
+{
+	StringPairArray params;
+	params.set("query", query);
+
+	if (filter.isNotEmpty()) {
+		params.set("filter", filter);
+	}
+
+	if (pageSize != -1) {
+		params.set("page_size", String(pageSize));
+	}
+
+	if (fields.isNotEmpty()) {
+		params.set("fields", fields);
+	}
+
+	FSRequest request(URIS::uri(URIS::TEXT_SEARCH, StringArray()), *this);
+	MemoryBlock body;
+	const int resultCode = request.requestBody(body, params, String(), false);
+
+	if (resultCode != 200) {
+		return "Search failed with status " + String(resultCode);
+	}
+
+	return FSSoundListDecoder::benchmark(body);
+}
+
+//Response cache
+
+JUCE_IMPLEMENT_SINGLETON(FSResponseCache)
+
+FSResponseCache::FSResponseCache()
+{
+	diskFolder = File::getSpecialLocation(File::userApplicationDataDirectory)
+		.getChildFile("FreesoundAPI").getChildFile("ResponseCache");
+}
+
+FSResponseCache::~FSResponseCache()
+{
+	clearSingletonInstance();
+}
+
+String FSResponseCache::makeKey(const URL& url, const String& authHeader)
+{
+	//Parameters sorted by name, so the order the caller set them in doesn't matter
+	StringArray names = url.getParameterNames();
+	StringArray values = url.getParameterValues();
+	StringArray pairs;
+
+	for (int i = 0; i < names.size(); ++i) { pairs.add(names[i] + "=" + values[i]); }
+	pairs.sort(false);
+
+	//Only a hash of the credentials ends up in the key and on disk
+	String scope = authHeader.isEmpty() ? String("anonymous") : String::toHexString(authHeader.hashCode64());
+
+	return scope + " " + url.toString(false) + "?" + pairs.joinIntoString("&");
+}
+
+RelativeTime FSResponseCache::getTimeToLive(const URL& url)
+{
+	String path = url.toString(false).fromFirstOccurrenceOf(URIS::BASE, false, false);
+	StringArray parts = StringArray::fromTokens(path, "/", "");
+	parts.removeEmptyStrings();
+
+	if (parts.isEmpty()) { return RelativeTime(); }
+
+	const String& kind = parts[0];
+
+	//Search results move as sounds are uploaded and rated
+	if (kind == "search") { return RelativeTime::hours(1); }
+
+	if (kind == "sounds" && parts.size() == 2 && parts[1] != "pending_uploads") { return RelativeTime::days(7); }
+	if (kind == "sounds" && parts.size() == 3 && parts[2] == "analysis") { return RelativeTime::days(30); }
+	if (kind == "sounds" && parts.size() == 3 && parts[2] == "similar") { return RelativeTime::days(1); }
+
+	if (kind == "users" && parts.size() >= 2 && parts.size() <= 5) { return RelativeTime::hours(1); }
+
+	if (kind == "packs" && (parts.size() == 2 || (parts.size() == 3 && parts[2] == "sounds"))) { return RelativeTime::days(1); }
+
+	//Everything else is either the user's own data or changes something
+	return RelativeTime();
+}
+
+bool FSResponseCache::lookup(const String& key, Entry& result)
+{
+	{
+		const ScopedLock sl(lock);
+		auto found = memory.find(key);
+
+		if (found != memory.end()) {
+			found->second.lastUsed = ++useCounter;
+			result = found->second.entry;
+			return true;
+		}
+	}
+
+	if (!readFromDisk(key, result)) { return false; }
+
+	//Responses read from disk are kept in memory for the next time. They're
+	//parsed by whoever reads them, as not every reader wants a var.
+	addToMemory(result);
+	return true;
+}
+
+void FSResponseCache::store(const String& key, const URL& url, const var& response, const String& body,
+							const String& eTag, const String& lastModified)
+{
+	const RelativeTime ttl = getTimeToLive(url);
+	if (ttl.inMilliseconds() <= 0) { return; }
+
+	Entry entry;
+	entry.key = key;
+	entry.response = response;
+	entry.body = body;
+	entry.eTag = eTag;
+	entry.lastModified = lastModified;
+	entry.storedAt = Time::currentTimeMillis();
+	entry.expiresAt = entry.storedAt + ttl.inMilliseconds();
+
+	addToMemory(entry);
+	writeToDisk(entry);
+}
+
+void FSResponseCache::refresh(Entry& entry, const URL& url)
+{
+	entry.storedAt = Time::currentTimeMillis();
+	entry.expiresAt = entry.storedAt + getTimeToLive(url).inMilliseconds();
+
+	addToMemory(entry);
+	writeToDisk(entry);
+}
+
+void FSResponseCache::setDiskCacheFolder(const File& folder)
+{
+	const ScopedLock sl(lock);
+	diskFolder = folder;
+}
+
+void FSResponseCache::clear()
+{
+	const ScopedLock sl(lock);
+	memory.clear();
+	memoryBytes = 0;
+
+	if (diskFolder.isDirectory()) {
+		for (auto& file : diskFolder.findChildFiles(File::findFiles, false, "*.fsc")) { file.deleteFile(); }
+	}
+}
+
+void FSResponseCache::addToMemory(const Entry& entry)
+{
+	const ScopedLock sl(lock);
+	const int64 size = (int64)entry.body.getNumBytesAsUTF8() + estimateSize(entry.response);
+
+	//Anything this big would push out most of the rest: it stays on disk only
+	if (size > maxMemoryBytes / 4) { return; }
+
+	auto existing = memory.find(entry.key);
+	if (existing != memory.end()) {
+		memoryBytes -= existing->second.size;
+		memory.erase(existing);
+	}
+
+	while (memoryBytes + size > maxMemoryBytes && !memory.empty()) {
+		auto oldest = memory.begin();
+
+		for (auto i = memory.begin(); i != memory.end(); ++i) {
+			if (i->second.lastUsed < oldest->second.lastUsed) { oldest = i; }
+		}
+
+		memoryBytes -= oldest->second.size;
+		memory.erase(oldest);
+	}
+
+	MemoryEntry& added = memory[entry.key];
+	added.entry = entry;
+	added.size = size;
+	added.lastUsed = ++useCounter;
+	memoryBytes += size;
+}
+
+int64 FSResponseCache::estimateSize(const var& value)
+{
+	//Roughly what the tree holds on the heap: a var per value, plus each
+	//string's text and each property's slot
+	int64 size = (int64)sizeof(var);
+
+	if (value.isString()) {
+		size += (int64)value.toString().getNumBytesAsUTF8();
+	}
+	else if (auto* array = value.getArray()) {
+		for (const var& element : *array) { size += estimateSize(element); }
+	}
+	else if (auto* object = value.getDynamicObject()) {
+		for (const auto& property : object->getProperties()) {
+			size += (int64)sizeof(NamedValueSet::NamedValue) + estimateSize(property.value);
+		}
+	}
+
+	return size;
+}
+
+File FSResponseCache::getDiskFile(const String& key) const
+{
+	return diskFolder.getChildFile(String::toHexString(key.hashCode64()) + ".fsc");
+}
+
+bool FSResponseCache::readFromDisk(const String& key, Entry& result)
+{
+	File file;
+	{
+		const ScopedLock sl(lock);
+		if (diskFolder == File()) { return false; }
+		file = getDiskFile(key);
+	}
+
+	FileInputStream in(file);
+	if (!in.openedOk()) { return false; }
+
+	//Key first, so a hash collision reads as a miss
+	if (in.readString() != key) { return false; }
+
+	result.key = key;
+	result.eTag = in.readString();
+	result.lastModified = in.readString();
+	result.storedAt = in.readInt64();
+	result.expiresAt = in.readInt64();
+	result.body = in.readString();
+
+	return result.body.isNotEmpty();
+}
+
+void FSResponseCache::writeToDisk(const Entry& entry)
+{
+	File file;
+	{
+		const ScopedLock sl(lock);
+		if (diskFolder == File() || !diskFolder.createDirectory()) { return; }
+		file = getDiskFile(entry.key);
+	}
+
+	MemoryOutputStream out;
+	out.writeString(entry.key);
+	out.writeString(entry.eTag);
+	out.writeString(entry.lastModified);
+	out.writeInt64(entry.storedAt);
+	out.writeInt64(entry.expiresAt);
+	out.writeString(entry.body);
+
+	//Written beside the entry and renamed over it, so readers never see half of one
+	TemporaryFile temp(file);
+	if (temp.getFile().replaceWithData(out.getData(), out.getDataSize())) { temp.overwriteTargetFileWithTemporary(); }
+
+	bool shouldTrim;
+	{
+		const ScopedLock sl(lock);
+		shouldTrim = ++writesSinceTrim >= 50;
+		if (shouldTrim) { writesSinceTrim = 0; }
+	}
+
+	if (shouldTrim) { trimDiskCache(); }
+}
+
+void FSResponseCache::trimDiskCache()
+{
+	File folder;
+	{
+		const ScopedLock sl(lock);
+		folder = diskFolder;
+	}
+
+	Array<File> files = folder.findChildFiles(File::findFiles, false, "*.fsc");
+	int64 total = 0;
+
+	for (auto& file : files) { total += file.getSize(); }
+	if (total <= maxDiskBytes) { return; }
+
+	//Least recently written first
+	std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+		return a.getLastModificationTime() < b.getLastModificationTime();
+	});
+
+	for (auto& file : files) {
+		if (total <= maxDiskBytes * 3 / 4) { break; }
+		total -= file.getSize();
+		file.deleteFile();
+	}
+}
+
+//Cancellation of asynchronous calls: the token of the call running on each thread
+static thread_local FSCancellationToken* currentCancellationToken = nullptr;
+
+FSCancellationToken* FSCancellationToken::getCurrent()
+{
+	return currentCancellationToken;
+}
+
+FSCancellationToken::ScopedCurrent::ScopedCurrent(FSCancellationToken& token)
+	: previous(currentCancellationToken)
+{
+	currentCancellationToken = &token;
+}
+
+FSCancellationToken::ScopedCurrent::~ScopedCurrent()
+{
+	currentCancellationToken = previous;
+}
+
+void FSCancellationToken::cancel()
+{
+	const ScopedLock sl(streamLock);
+	cancelled = true;
+
+	//Unblocks a request that is waiting on the server
+	if (activeStream != nullptr) { activeStream->cancel(); }
+}
+
+bool FSCancellationToken::attachStream(WebInputStream* stream)
+{
+	const ScopedLock sl(streamLock);
+	if (cancelled.load()) { return false; }
+	activeStream = stream;
+	return true;
+}
+
+void FSCancellationToken::detachStream()
+{
+	const ScopedLock sl(streamLock);
+	activeStream = nullptr;
+}
+
+JUCE_IMPLEMENT_SINGLETON(FSRequestPool)
+
+FSRequestPool::~FSRequestPool()
+{
+	//Calls still queued at shutdown are dropped, the ones running are stopped
+	removeAllJobs(true, 5000);
+	clearSingletonInstance();
+}
+
+
 
 
 
@@ -790,30 +1403,160 @@ void FreesoundClientComponent::setCallback(Callback cb)
 
 
 
+namespace
+{
+	//The response as the consumer reads it. Stops when the call is cancelled, and
+	//keeps a copy of what went through for the cache.
+	class ResponseBodyStream : public InputStream
+	{
+	public:
+		ResponseBodyStream(InputStream& sourceStream, FSCancellationToken* tokenToCheck, MemoryOutputStream* copyToKeep)
+			: source(sourceStream), token(tokenToCheck), copy(copyToKeep) {}
+
+		int64 getTotalLength() override { return source.getTotalLength(); }
+		bool isExhausted() override { return isCancelled() || source.isExhausted(); }
+		int64 getPosition() override { return source.getPosition(); }
+		bool setPosition(int64) override { return false; }
+
+		int read(void* destBuffer, int maxBytesToRead) override
+		{
+			if (isCancelled()) { return 0; }
+
+			const int numRead = source.read(destBuffer, maxBytesToRead);
+			if (numRead > 0 && copy != nullptr) { copy->write(destBuffer, (size_t)numRead); }
+			return numRead;
+		}
+
+	private:
+		bool isCancelled() const { return token != nullptr && token->isCancelled(); }
+
+		InputStream& source;
+		FSCancellationToken* token;
+		MemoryOutputStream* copy;
+	};
+}
+
 Response FSRequest::request(StringPairArray params, String data, bool postLikeRequest)
 {
+	var response;
+
+	//Error bodies are parsed too, they carry the API's explanation
+	const int statusCode = fetch(params, data, postLikeRequest, true, [&response](InputStream& body, var& parsed) {
+		if (parsed.isVoid()) { parsed = JSON::parse(body.readEntireStreamAsString()); }
+		response = parsed;
+		return !response.isVoid();
+	});
 
+	return Response(statusCode, response);
+}
+
+int FSRequest::requestSounds(SoundList& result, StringPairArray params, String data, bool postLikeRequest)
+{
+	//Nothing is left in parsed, so the cache keeps only the body
+	return fetch(params, data, postLikeRequest, false, [&result](InputStream& body, var&) {
+		return FSSoundListDecoder::decode(body, result);
+	});
+}
+
+int FSRequest::requestSoundTable(FSSoundTable& result, StringPairArray params, String data, bool postLikeRequest)
+{
+	return fetch(params, data, postLikeRequest, false, [&result](InputStream& body, var&) {
+		return FSSoundListDecoder::decode(body, result);
+	});
+}
+
+int FSRequest::requestBody(MemoryBlock& body, StringPairArray params, String data, bool postLikeRequest)
+{
+	return fetch(params, data, postLikeRequest, false, [&body](InputStream& input, var&) {
+		body.reset();
+		return input.readIntoMemoryBlock(body) > 0;
+	});
+}
+
+int FSRequest::fetch(const StringPairArray& params, const String& data, bool postLikeRequest, bool consumeErrorBody, const BodyConsumer& consume)
+{
 	URL url = uri;
 	String header;
-	int statusCode = -1;
-	StringPairArray responseHeaders;
 	if (data.isNotEmpty()) { url = url.withPOSTData(data); }
 	if (params.size() != 0) { url = url.withParameters(params); }
 	if (client.isTokenNotEmpty()) { header = "Authorization: " + client.getHeader(); }
 
+	//Reads are answered from the cache while fresh, and revalidated once stale
+	FSResponseCache* cache = (client.useResponseCache && !postLikeRequest && data.isEmpty()
+							  && FSResponseCache::getTimeToLive(url).inMilliseconds() > 0)
+		? FSResponseCache::getInstance() : nullptr;
+
+	String cacheKey;
+	FSResponseCache::Entry cached;
+	bool haveCached = false;
+
+	auto consumeCached = [&]() -> int {
+		MemoryInputStream body(cached.body.toRawUTF8(), cached.body.getNumBytesAsUTF8(), false);
+		return consume(body, cached.response) ? 200 : -1;
+	};
+
+	if (cache != nullptr) {
+		cacheKey = FSResponseCache::makeKey(url, header);
+		haveCached = cache->lookup(cacheKey, cached);
+		if (haveCached && cached.isFresh()) { return consumeCached(); }
+	}
+
+	String requestHeaders = header;
+	if (haveCached && cached.eTag.isNotEmpty()) { requestHeaders += "\r\nIf-None-Match: " + cached.eTag; }
+	if (haveCached && cached.lastModified.isNotEmpty()) { requestHeaders += "\r\nIf-Modified-Since: " + cached.lastModified; }
+	requestHeaders = requestHeaders.trimCharactersAtStart("\r\n");
+
+	//Requests made from an asynchronous call stop when it's cancelled
+	FSCancellationToken* token = FSCancellationToken::getCurrent();
+
+	WebInputStream stream(url, postLikeRequest);
+	stream.withExtraHeaders(requestHeaders).withConnectionTimeout(client.requestTimeoutMs);
+
+	if (token != nullptr && !token->attachStream(&stream)) { return -1; }
 
 	//Try to open a stream with this information.
-	if (auto stream = std::unique_ptr<InputStream>(url.createInputStream(postLikeRequest, nullptr, nullptr, header,
-		10000, // timeout in millisecs
-		&responseHeaders, &statusCode)))
-	{
-		//Stream created successfully, store the response, log it and return the response in a pair containing (statusCode, response)
-		String resp = stream->readEntireStreamAsString();
-		var response = JSON::parse(resp);
-		return Response(statusCode, response);
+	bool connected = stream.connect(nullptr);
+	int statusCode = stream.getStatusCode();
+
+	//Not modified: the cached copy is good for another period. Offline or the
+	//server is in trouble: a stale answer beats none.
+	if (haveCached && ((connected && statusCode == 304) || !connected || statusCode <= 0 || statusCode >= 500)) {
+		if (token != nullptr) { token->detachStream(); }
+		if (token != nullptr && token->isCancelled()) { return -1; }
+		if (connected && statusCode == 304) { cache->refresh(cached, url); }
+		return consumeCached();
+	}
+
+	//Couldnt create stream, or an error the caller can't decode: return the
+	//status code and leave the consumer out
+	const bool succeeded = statusCode >= 200 && statusCode < 300;
+	if (!connected || (!succeeded && !consumeErrorBody)) {
+		if (token != nullptr) { token->detachStream(); }
+		return statusCode;
+	}
+
+	//The body is consumed while it downloads, in blocks, so a cancel stops the
+	//transfer. Only a cacheable response is copied on the way.
+	const bool keepBody = cache != nullptr && statusCode == 200;
+	MemoryOutputStream bodyCopy;
+	ResponseBodyStream body(stream, token, keepBody ? &bodyCopy : nullptr);
+
+	var parsed;
+	const bool consumed = consume(body, parsed);
+
+	if (token != nullptr) {
+		token->detachStream();
+		if (token->isCancelled()) { return -1; }
+	}
+
+	if (keepBody && consumed) {
+		const StringPairArray responseHeaders = stream.getResponseHeaders();
+		cache->store(cacheKey, url, parsed, bodyCopy.toString(),
+					 responseHeaders.getValue("ETag", String()), responseHeaders.getValue("Last-Modified", String()));
 	}
-	//Couldnt create stream, return (-1, emptyVar)
-	return Response(statusCode, var());
+
+	//A success whose body couldn't be read is no success
+	return (succeeded && !consumed) ? -1 : statusCode;
 }
 
 FSList::FSList()
@@ -879,9 +1622,9 @@ FSSound::FSSound(var sound)
 	bookmark = URL(sound["bookmark"]);
 	previews = sound["previews"];
     images = sound["images"];
-	numDownloads = sound["images"];
-	avgRating = sound["num_downloads"];
-	numRatings = sound["avg_rating"];
+	numDownloads = sound["num_downloads"];
+	avgRating = sound["avg_rating"];
+	numRatings = sound["num_ratings"];
 	rate = URL(sound["rate"]);
 	comments = URL(sound["comments"]);
 	numComments = sound["num_comments"];
@@ -891,9 +1634,6 @@ FSSound::FSSound(var sound)
 	analysisStats = URL(sound["analysis_stats"]);
 	analysisFrames = URL(sound["analysis_frames"]);
 	acAnalysis = sound["ac_analysis"];
-
-	std::cout << "FSSound created with id: " << id << std::endl;
-
 }
 
 URL FSSound::getDownload()
@@ -967,7 +1707,7 @@ String FSPack::getID()
 
 Array<FSSound> SoundList::toArrayOfSounds()
 {
-
+	if (isDecoded) { return decodedSounds; }
 
 	Array<FSSound> arrayOfSounds;
 
@@ -978,3 +1718,712 @@ Array<FSSound> SoundList::toArrayOfSounds()
 
 	return arrayOfSounds;
 }
+
+//Sound table
+
+FSSoundTable::FSSoundTable(const Array<FSSound>& sounds)
+{
+	reserve(sounds.size());
+	for (const auto& sound : sounds) { add(sound); }
+}
+
+void FSSoundTable::add(const FSSound& sound)
+{
+	addRow(sound, (float)sound.duration);
+}
+
+void FSSoundTable::add(const Row& row)
+{
+	addRow(row.toSound(), row.getDuration());
+}
+
+void FSSoundTable::addRow(const FSSound& sound, float duration)
+{
+	ids.push_back(sound.id.getLargeIntValue());
+	durations.push_back(duration);
+
+	Numbers row;
+	row.filesize = sound.filesize;
+	row.samplerate = sound.samplerate;
+	row.bitrate = sound.bitrate;
+	row.numDownloads = sound.numDownloads;
+	row.numRatings = sound.numRatings;
+	row.avgRating = sound.avgRating;
+	row.channels = (uint8)jlimit(0, 255, sound.channels);
+	row.bitdepth = (uint8)jlimit(0, 255, sound.bitdepth);
+	numbers.push_back(row);
+
+	users.push_back(intern(sound.user));
+	licenses.push_back(intern(sound.license));
+	formats.push_back(intern(sound.format));
+	names.push_back(addText(sound.name));
+	descriptions.push_back(addText(sound.description));
+
+	for (const auto& tag : sound.tags) { tagIds.push_back(intern(tag)); }
+	tagStarts.push_back((uint32)tagIds.size());
+
+	const String preview = sound.previews["preview-hq-ogg"].toString();
+	previewFolders.push_back(intern(preview.upToLastOccurrenceOf("/", true, false)));
+	previewFiles.push_back(addText(preview.fromLastOccurrenceOf("/", false, false)));
+}
+
+int FSSoundTable::indexOf(int64 soundId) const
+{
+	auto found = std::find(ids.begin(), ids.end(), soundId);
+	return found == ids.end() ? -1 : (int)(found - ids.begin());
+}
+
+void FSSoundTable::clear()
+{
+	*this = FSSoundTable();
+}
+
+void FSSoundTable::reserve(int numRows)
+{
+	const size_t rows = (size_t)jmax(0, numRows);
+
+	ids.reserve(rows);
+	durations.reserve(rows);
+	numbers.reserve(rows);
+	users.reserve(rows);
+	licenses.reserve(rows);
+	formats.reserve(rows);
+	names.reserve(rows);
+	descriptions.reserve(rows);
+	tagStarts.reserve(rows + 1);
+	previewFolders.reserve(rows);
+	previewFiles.reserve(rows);
+}
+
+Array<FSSound> FSSoundTable::toArrayOfSounds() const
+{
+	Array<FSSound> sounds;
+	sounds.ensureStorageAllocated(size());
+
+	for (int i = 0; i < size(); ++i) { sounds.add((*this)[i].toSound()); }
+
+	return sounds;
+}
+
+Array<FSSound> FSSoundTable::toArrayOfSounds(const Array<int>& rowIndices) const
+{
+	Array<FSSound> sounds;
+	sounds.ensureStorageAllocated(rowIndices.size());
+
+	for (int index : rowIndices) { sounds.add((*this)[index].toSound()); }
+
+	return sounds;
+}
+
+size_t FSSoundTable::getMemoryUsage() const
+{
+	size_t bytes = sizeof(*this);
+
+	bytes += ids.capacity() * sizeof(int64) + durations.capacity() * sizeof(float);
+	bytes += numbers.capacity() * sizeof(Numbers);
+	bytes += (users.capacity() + licenses.capacity() + formats.capacity() + previewFolders.capacity()) * sizeof(uint32);
+	bytes += (names.capacity() + descriptions.capacity() + previewFiles.capacity()) * sizeof(TextSpan);
+	bytes += (tagIds.capacity() + tagStarts.capacity()) * sizeof(uint32);
+	bytes += text.capacity();
+
+	//Each interned string once, plus its entry in the lookup map
+	for (const auto& string : interned) {
+		bytes += string.getNumBytesAsUTF8() + sizeof(String) * 2 + sizeof(uint32) + 32;
+	}
+
+	return bytes;
+}
+
+uint32 FSSoundTable::intern(const String& string)
+{
+	auto found = internedIndices.find(string);
+	if (found != internedIndices.end()) { return found->second; }
+
+	const uint32 index = (uint32)interned.size();
+	interned.add(string);
+	internedIndices.emplace(string, index);
+	return index;
+}
+
+FSSoundTable::TextSpan FSSoundTable::addText(const String& string)
+{
+	TextSpan span;
+	span.start = (uint32)text.size();
+	span.length = (uint32)string.getNumBytesAsUTF8();
+	text.append(string.toRawUTF8(), span.length);
+	return span;
+}
+
+String FSSoundTable::getText(TextSpan span) const
+{
+	return String::fromUTF8(text.data() + span.start, (int)span.length);
+}
+
+StringArray FSSoundTable::Row::getTags() const
+{
+	StringArray tags;
+	for (int i = 0; i < getNumTags(); ++i) { tags.add(getTag(i)); }
+	return tags;
+}
+
+String FSSoundTable::Row::getOGGPreviewURL() const
+{
+	const String file = table->getText(table->previewFiles[(size_t)index]);
+	if (file.isEmpty()) { return String(); }
+
+	return table->getInterned(table->previewFolders[(size_t)index]) + file;
+}
+
+FSSound FSSoundTable::Row::toSound() const
+{
+	FSSound sound;
+	const Numbers& row = table->numbers[(size_t)index];
+
+	sound.id = getIdString();
+	sound.name = getName();
+	sound.description = getDescription();
+	sound.user = getUser();
+	sound.license = getLicense();
+	sound.format = getFormat();
+	sound.tags = getTags();
+	sound.duration = (int)getDuration();
+	sound.filesize = row.filesize;
+	sound.samplerate = row.samplerate;
+	sound.bitrate = row.bitrate;
+	sound.numDownloads = row.numDownloads;
+	sound.numRatings = row.numRatings;
+	sound.avgRating = row.avgRating;
+	sound.channels = row.channels;
+	sound.bitdepth = row.bitdepth;
+
+	const String preview = getOGGPreviewURL();
+
+	if (preview.isNotEmpty()) {
+		DynamicObject::Ptr previews = new DynamicObject();
+		previews->setProperty("preview-hq-ogg", preview);
+		sound.previews = var(previews.get());
+	}
+
+	return sound;
+}
+
+//Streaming decoder for sound lists
+
+namespace
+{
+	//Pull parser over an InputStream. Reads the stream in blocks and never holds
+	//more of it than one block, so the size of the response doesn't matter.
+	class JSONPullReader
+	{
+	public:
+		explicit JSONPullReader(InputStream& source) : input(source), buffer(blockSize) {}
+
+		int peek()
+		{
+			if (position == end && !refill()) { return -1; }
+			return (uint8)buffer[position];
+		}
+
+		int next()
+		{
+			const int c = peek();
+			if (c >= 0) { ++position; }
+			return c;
+		}
+
+		int peekAfterWhitespace()
+		{
+			for (;;) {
+				const int c = peek();
+				if (c != ' ' && c != '\t' && c != '\n' && c != '\r') { return c; }
+				++position;
+			}
+		}
+
+		bool expect(char wanted)
+		{
+			if (peekAfterWhitespace() != wanted) { return false; }
+			++position;
+			return true;
+		}
+
+		//Reads a string's UTF-8 bytes into out, reusing its storage
+		bool readString(std::string& out)
+		{
+			out.clear();
+			if (!expect('"')) { return false; }
+
+			for (;;) {
+				int c = next();
+				if (c < 0) { return false; }
+				if (c == '"') { return true; }
+				if (c != '\\') { out.push_back((char)c); continue; }
+
+				c = next();
+				switch (c) {
+				case '"': case '\\': case '/': out.push_back((char)c); break;
+				case 'b': out.push_back('\b'); break;
+				case 'f': out.push_back('\f'); break;
+				case 'n': out.push_back('\n'); break;
+				case 'r': out.push_back('\r'); break;
+				case 't': out.push_back('\t'); break;
+				case 'u': {
+					uint32 code = 0;
+					if (!readHex4(code)) { return false; }
+
+					//A surrogate pair encodes one character outside the BMP
+					if (code >= 0xd800 && code < 0xdc00 && peek() == '\\') {
+						next();
+						uint32 low = 0;
+						if (next() != 'u' || !readHex4(low)) { return false; }
+						code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					}
+
+					appendUTF8(out, code);
+					break;
+				}
+				default: return false;
+				}
+			}
+		}
+
+		bool readString(String& out)
+		{
+			if (!readString(scratch)) { return false; }
+			out = String::fromUTF8(scratch.data(), (int)scratch.size());
+			return true;
+		}
+
+		//Strings and nulls, as the Freesound API sends null for missing URLs
+		bool readStringOrNull(String& out)
+		{
+			if (peekAfterWhitespace() == 'n') { out = String(); return readLiteral("null"); }
+			return readString(out);
+		}
+
+		bool readNumberToken(std::string& out)
+		{
+			out.clear();
+			peekAfterWhitespace();
+
+			for (;;) {
+				const int c = peek();
+				if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) { break; }
+				out.push_back((char)c);
+				++position;
+			}
+
+			return !out.empty();
+		}
+
+		bool readNumber(double& out)
+		{
+			if (peekAfterWhitespace() == 'n') { out = 0.0; return readLiteral("null"); }
+			if (!readNumberToken(scratch)) { return false; }
+
+			//Locale independent, unlike strtod
+			auto text = CharPointer_ASCII(scratch.c_str());
+			out = CharacterFunctions::readDoubleValue(text);
+			return true;
+		}
+
+		bool readLiteral(const char* literal)
+		{
+			peekAfterWhitespace();
+			for (; *literal != 0; ++literal) {
+				if (next() != *literal) { return false; }
+			}
+			return true;
+		}
+
+		//Generic value, for the few fields that are whole dictionaries
+		bool readValue(var& out, int depth = 0)
+		{
+			if (depth > maxDepth) { return false; }
+
+			switch (peekAfterWhitespace()) {
+			case '{': {
+				++position;
+				DynamicObject::Ptr object = new DynamicObject();
+
+				if (peekAfterWhitespace() == '}') { ++position; out = var(object.get()); return true; }
+
+				for (;;) {
+					String key;
+					var value;
+					if (!readString(key) || !expect(':') || !readValue(value, depth + 1)) { return false; }
+					object->setProperty(key, value);
+
+					const int c = peekAfterWhitespace();
+					++position;
+					if (c == '}') { break; }
+					if (c != ',') { return false; }
+				}
+
+				out = var(object.get());
+				return true;
+			}
+			case '[': {
+				++position;
+				Array<var> items;
+
+				if (peekAfterWhitespace() == ']') { ++position; out = items; return true; }
+
+				for (;;) {
+					var item;
+					if (!readValue(item, depth + 1)) { return false; }
+					items.add(item);
+
+					const int c = peekAfterWhitespace();
+					++position;
+					if (c == ']') { break; }
+					if (c != ',') { return false; }
+				}
+
+				out = items;
+				return true;
+			}
+			case '"': {
+				String text;
+				if (!readString(text)) { return false; }
+				out = text;
+				return true;
+			}
+			case 't': out = true; return readLiteral("true");
+			case 'f': out = false; return readLiteral("false");
+			case 'n': out = var(); return readLiteral("null");
+			default: {
+				if (!readNumberToken(scratch)) { return false; }
+				const bool isInteger = scratch.find_first_of(".eE") == std::string::npos;
+				auto text = CharPointer_ASCII(scratch.c_str());
+				if (isInteger) { out = String(scratch.c_str()).getLargeIntValue(); }
+				else { out = CharacterFunctions::readDoubleValue(text); }
+				return true;
+			}
+			}
+		}
+
+		//Steps over a value without building anything
+		bool skipValue()
+		{
+			int depth = 0;
+
+			do {
+				switch (peekAfterWhitespace()) {
+				case '{': case '[': ++position; ++depth; break;
+				case '}': case ']': ++position; --depth; break;
+				case ',': case ':': ++position; break;
+				case '"': if (!skipString()) { return false; } break;
+				case -1: return false;
+				default: if (!readNumberToken(scratch) && !skipWord()) { return false; } break;
+				}
+			} while (depth > 0);
+
+			return true;
+		}
+
+		//Calls fn for each key of an object, with the reader positioned on its value
+		template <typename Function>
+		bool forEachMember(Function&& fn)
+		{
+			if (!expect('{')) { return false; }
+			if (peekAfterWhitespace() == '}') { ++position; return true; }
+
+			std::string key;
+
+			for (;;) {
+				if (!readString(key) || !expect(':') || !fn(key)) { return false; }
+
+				const int c = peekAfterWhitespace();
+				++position;
+				if (c == '}') { return true; }
+				if (c != ',') { return false; }
+			}
+		}
+
+		template <typename Function>
+		bool forEachElement(Function&& fn)
+		{
+			if (!expect('[')) { return false; }
+			if (peekAfterWhitespace() == ']') { ++position; return true; }
+
+			for (;;) {
+				if (!fn()) { return false; }
+
+				const int c = peekAfterWhitespace();
+				++position;
+				if (c == ']') { return true; }
+				if (c != ',') { return false; }
+			}
+		}
+
+	private:
+		static constexpr int blockSize = 16384;
+		static constexpr int maxDepth = 64;
+
+		bool refill()
+		{
+			const int numRead = input.read(buffer.getData(), blockSize);
+			position = 0;
+			end = jmax(0, numRead);
+			return end > 0;
+		}
+
+		bool readHex4(uint32& out)
+		{
+			for (int i = 0; i < 4; ++i) {
+				const int digit = CharacterFunctions::getHexDigitValue((juce_wchar)next());
+				if (digit < 0) { return false; }
+				out = (out << 4) | (uint32)digit;
+			}
+			return true;
+		}
+
+		static void appendUTF8(std::string& out, uint32 code)
+		{
+			if (code < 0x80) { out.push_back((char)code); }
+			else if (code < 0x800) { out.push_back((char)(0xc0 | (code >> 6))); out.push_back((char)(0x80 | (code & 0x3f))); }
+			else if (code < 0x10000) {
+				out.push_back((char)(0xe0 | (code >> 12)));
+				out.push_back((char)(0x80 | ((code >> 6) & 0x3f)));
+				out.push_back((char)(0x80 | (code & 0x3f)));
+			}
+			else {
+				out.push_back((char)(0xf0 | (code >> 18)));
+				out.push_back((char)(0x80 | ((code >> 12) & 0x3f)));
+				out.push_back((char)(0x80 | ((code >> 6) & 0x3f)));
+				out.push_back((char)(0x80 | (code & 0x3f)));
+			}
+		}
+
+		bool skipString()
+		{
+			++position;
+			for (;;) {
+				const int c = next();
+				if (c < 0) { return false; }
+				if (c == '"') { return true; }
+				if (c == '\\') { next(); }
+			}
+		}
+
+		bool skipWord()
+		{
+			bool any = false;
+			while (CharacterFunctions::isLetter((juce_wchar)peek())) { ++position; any = true; }
+			return any;
+		}
+
+		InputStream& input;
+		HeapBlock<char> buffer;
+		int position = 0, end = 0;
+		std::string scratch;
+	};
+
+	bool readURL(JSONPullReader& reader, URL& out)
+	{
+		String text;
+		if (!reader.readStringOrNull(text)) { return false; }
+		if (text.isNotEmpty()) { out = URL(text); }
+		return true;
+	}
+
+	template <typename Number>
+	bool readNumberInto(JSONPullReader& reader, Number& out)
+	{
+		double value = 0.0;
+		if (!reader.readNumber(value)) { return false; }
+		out = (Number)value;
+		return true;
+	}
+
+	//One element of "results", mapped field by field. Fields the request didn't
+	//ask for aren't in the response, and unknown ones are skipped unread.
+	bool decodeSound(JSONPullReader& reader, FSSound& sound, double& duration)
+	{
+		std::string token;
+
+		return reader.forEachMember([&](const std::string& key) -> bool {
+			if (key == "id") {
+				if (!reader.readNumberToken(token)) { return false; }
+				sound.id = String(token.c_str());
+				return true;
+			}
+			if (key == "name") { return reader.readStringOrNull(sound.name); }
+			if (key == "username") { return reader.readStringOrNull(sound.user); }
+			if (key == "license") { return reader.readStringOrNull(sound.license); }
+			if (key == "description") { return reader.readStringOrNull(sound.description); }
+			if (key == "tags") {
+				sound.tags.clear();
+				return reader.forEachElement([&] {
+					String tag;
+					if (!reader.readString(tag)) { return false; }
+					sound.tags.add(tag);
+					return true;
+				});
+			}
+			if (key == "duration") {
+				//FSSound rounds it down to whole seconds, tables keep the fraction
+				if (!reader.readNumber(duration)) { return false; }
+				sound.duration = (int)duration;
+				return true;
+			}
+			if (key == "filesize") { return readNumberInto(reader, sound.filesize); }
+			if (key == "channels") { return readNumberInto(reader, sound.channels); }
+			if (key == "bitrate") { return readNumberInto(reader, sound.bitrate); }
+			if (key == "bitdepth") { return readNumberInto(reader, sound.bitdepth); }
+			if (key == "samplerate") { return readNumberInto(reader, sound.samplerate); }
+			if (key == "num_downloads") { return readNumberInto(reader, sound.numDownloads); }
+			if (key == "avg_rating") { return readNumberInto(reader, sound.avgRating); }
+			if (key == "num_ratings") { return readNumberInto(reader, sound.numRatings); }
+			if (key == "num_comments") { return readNumberInto(reader, sound.numComments); }
+			if (key == "geotag") { return reader.readStringOrNull(sound.geotag); }
+			if (key == "created") { return reader.readStringOrNull(sound.created); }
+			if (key == "type") { return reader.readStringOrNull(sound.format); }
+			if (key == "url") { return readURL(reader, sound.url); }
+			if (key == "pack") { return readURL(reader, sound.pack); }
+			if (key == "download") { return readURL(reader, sound.download); }
+			if (key == "bookmark") { return readURL(reader, sound.bookmark); }
+			if (key == "rate") { return readURL(reader, sound.rate); }
+			if (key == "comments") { return readURL(reader, sound.comments); }
+			if (key == "comment") { return readURL(reader, sound.comment); }
+			if (key == "similar_sounds") { return readURL(reader, sound.similarSounds); }
+			if (key == "analysis_stats") { return readURL(reader, sound.analysisStats); }
+			if (key == "analysis_frames") { return readURL(reader, sound.analysisFrames); }
+			if (key == "previews") { return reader.readValue(sound.previews); }
+			if (key == "images") { return reader.readValue(sound.images); }
+			if (key == "analysis") { return reader.readValue(sound.analysis); }
+			if (key == "ac_analysis") { return reader.readValue(sound.acAnalysis); }
+			return reader.skipValue();
+		});
+	}
+
+	//Heap in use by the process, for the benchmark. -1 where it can't be read.
+	int64 getHeapBytesInUse()
+	{
+	   #if JUCE_LINUX && defined(__GLIBC__)
+		#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+		return (int64)mallinfo2().uordblks;
+		#else
+		return (int64)(uint32)mallinfo().uordblks;
+		#endif
+	   #elif JUCE_MAC
+		malloc_statistics_t stats;
+		malloc_zone_statistics(nullptr, &stats);
+		return (int64)stats.size_in_use;
+	   #else
+		return -1;
+	   #endif
+	}
+}
+
+//Reads a list response's header fields and hands each result to addSound
+template <typename AddSound>
+static bool decodeSoundList(InputStream& input, int& count, String& nextPage, String& previousPage, AddSound&& addSound)
+{
+	JSONPullReader reader(input);
+
+	return reader.forEachMember([&](const std::string& key) -> bool {
+		if (key == "count") { return readNumberInto(reader, count); }
+		if (key == "next") { return reader.readStringOrNull(nextPage); }
+		if (key == "previous") { return reader.readStringOrNull(previousPage); }
+		if (key == "results") {
+			return reader.forEachElement([&] {
+				FSSound sound;
+				double duration = 0.0;
+				if (!decodeSound(reader, sound, duration)) { return false; }
+				addSound(std::move(sound), duration);
+				return true;
+			});
+		}
+		return reader.skipValue();
+	});
+}
+
+bool FSSoundListDecoder::decode(InputStream& input, SoundList& result)
+{
+	Array<FSSound> sounds;
+	int count = 0;
+	String nextPage, previousPage;
+
+	const bool ok = decodeSoundList(input, count, nextPage, previousPage, [&sounds](FSSound&& sound, double) {
+		sounds.add(std::move(sound));
+	});
+
+	if (!ok) { return false; }
+
+	result.count = count;
+	result.nextPage = nextPage;
+	result.previousPage = previousPage;
+	result.results = var();
+	result.decodedSounds = std::move(sounds);
+	result.isDecoded = true;
+	return true;
+}
+
+bool FSSoundListDecoder::decode(InputStream& input, FSSoundTable& result)
+{
+	FSSoundTable table;
+	String previousPage;
+
+	const bool ok = decodeSoundList(input, table.totalCount, table.nextPage, previousPage, [&table](FSSound&& sound, double duration) {
+		table.addRow(sound, (float)duration);
+	});
+
+	if (!ok) { return false; }
+
+	result = std::move(table);
+	return true;
+}
+
+String FSSoundListDecoder::benchmark(const MemoryBlock& body, int numRuns)
+{
+	String report = "Sound list decoding, " + String((double)body.getSize() / 1024.0, 1) + " KB response:\n";
+
+	double domSeconds = 0.0, streamSeconds = 0.0;
+	int64 domBytes = 0, streamBytes = 0;
+	int numSounds = 0;
+
+	for (int run = 0; run < jmax(1, numRuns); ++run) {
+		//Current path: the whole response as a String, a var tree, then the sounds.
+		//The tree is still alive when the last sound is built, which is the peak.
+		{
+			const int64 heapBefore = getHeapBytesInUse();
+			const int64 start = Time::getHighResolutionTicks();
+
+			String text = body.toString();
+			SoundList list(JSON::parse(text));
+			Array<FSSound> sounds = list.toArrayOfSounds();
+
+			domSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+			domBytes = jmax(domBytes, getHeapBytesInUse() - heapBefore);
+			numSounds = sounds.size();
+		}
+
+		//Streaming path: only the sounds are ever built
+		{
+			const int64 heapBefore = getHeapBytesInUse();
+			const int64 start = Time::getHighResolutionTicks();
+
+			MemoryInputStream input(body, false);
+			SoundList list;
+			decode(input, list);
+			Array<FSSound> sounds = list.toArrayOfSounds();
+
+			streamSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+			streamBytes = jmax(streamBytes, getHeapBytesInUse() - heapBefore);
+		}
+	}
+
+	const double runs = (double)jmax(1, numRuns);
+	const bool canMeasureHeap = getHeapBytesInUse() >= 0;
+
+	report << String(numSounds) << " sounds, average of " << String(jmax(1, numRuns)) << " runs\n";
+	report << "  var tree:  " << String(domSeconds * 1000.0 / runs, 2) << " ms";
+	if (canMeasureHeap) { report << ", " << String((double)domBytes / 1024.0, 1) << " KB heap"; }
+	report << "\n  streaming: " << String(streamSeconds * 1000.0 / runs, 2) << " ms";
+	if (canMeasureHeap) { report << ", " << String((double)streamBytes / 1024.0, 1) << " KB heap"; }
+	report << "\n";
+
+	return report;
+}
@@ -429,17 +429,17 @@ public:
 	/** \brief	The type of sound (wav, aif, aiff, mp3, m4a or flac) */
 	String format;
 	/** \brief	The number of channels */
-	int channels;
+	int channels = 0;
 	/** \brief	The size of the file in bytes */
-	int filesize;
+	int filesize = 0;
 	/** \brief	The bit rate of the sound in kbps */
-	int bitrate;
+	int bitrate = 0;
 	/** \brief	The bit depth of the sound */
-	int bitdepth;
+	int bitdepth = 0;
 	/** \brief	The duration of the sound in seconds */
-	int duration;
+	int duration = 0;
 	/** \brief	The samplerate of the sound */
-	int samplerate;
+	int samplerate = 0;
 	/** \brief	The username of the uploader of the sound */
 	String user;
 	/** \brief	If the sound is part of a pack, this URI points to that pack’s API resource */
@@ -453,17 +453,17 @@ public:
 	/** \brief	Dictionary including the URIs for spectrogram and waveform visualizations of the sound */
 	var images;
 	/** \brief	The number of times the sound was downloaded */
-	int numDownloads;
+	int numDownloads = 0;
 	/** \brief	The average rating of the sound */
-	float avgRating;
+	float avgRating = 0.0f;
 	/** \brief	The number of times the sound was rated */
-	int numRatings;
+	int numRatings = 0;
 	/** \brief	The URI for rating the sound */
 	URL rate;
 	/** \brief	The URI of a paginated list of the comments of the sound */
 	URL comments;
 	/** \brief	The number of comments */
-	int numComments;
+	int numComments = 0;
 	/** \brief	The URI to comment the sound*/
 	URL comment;
 	/** \brief	URI pointing to the similarity resource (to get a list of similar sounds) */
@@ -555,6 +555,527 @@ public:
 	 */
 
 	Array<FSSound> toArrayOfSounds();
+
+private:
+	friend class FSSoundListDecoder;
+
+	/** \brief	The sounds, when the list was decoded straight from the response
+				(then the results var is left empty) */
+	Array<FSSound> decodedSounds;
+	bool isDecoded = false;
+};
+
+/**
+ * \class	FSSoundTable
+ *
+ * \brief	Sounds stored column by column rather than as FSSound objects, for holding
+ *			many search results at once. IDs, durations and the other numbers are kept
+ *			in contiguous arrays. Usernames, licenses, formats, tags and preview
+ *			folders are interned, so each row only stores indices for them. Names,
+ *			descriptions and preview file names share one UTF-8 buffer. A row costs
+ *			the size of its text plus a few dozen bytes, where an FSSound carries a
+ *			dozen URLs and vars.
+ *
+ *			Rows are read through Row, a view that copies nothing. Row::toSound()
+ *			builds an FSSound when one is needed. It has the fields the table keeps
+ *			(see add()); the other URL and var fields are left empty.
+ */
+
+class FSSoundTable {
+public:
+
+	/**
+	 * \class	FSSoundTable::Row
+	 *
+	 * \brief	One row of a table. Only valid while the table is alive and unchanged.
+	 */
+
+	class Row {
+	public:
+		Row(const FSSoundTable& owner, int rowIndex) : table(&owner), index(rowIndex) {}
+
+		int getIndex() const { return index; }
+		int64 getId() const { return table->ids[(size_t)index]; }
+		String getIdString() const { return String(getId()); }
+		String getName() const { return table->getText(table->names[(size_t)index]); }
+		String getDescription() const { return table->getText(table->descriptions[(size_t)index]); }
+		const String& getUser() const { return table->getInterned(table->users[(size_t)index]); }
+		const String& getLicense() const { return table->getInterned(table->licenses[(size_t)index]); }
+		const String& getFormat() const { return table->getInterned(table->formats[(size_t)index]); }
+		float getDuration() const { return table->durations[(size_t)index]; }
+		int getFilesize() const { return table->numbers[(size_t)index].filesize; }
+		int getChannels() const { return table->numbers[(size_t)index].channels; }
+		int getSamplerate() const { return table->numbers[(size_t)index].samplerate; }
+		int getBitrate() const { return table->numbers[(size_t)index].bitrate; }
+		int getBitdepth() const { return table->numbers[(size_t)index].bitdepth; }
+		int getNumDownloads() const { return table->numbers[(size_t)index].numDownloads; }
+		int getNumRatings() const { return table->numbers[(size_t)index].numRatings; }
+		float getAvgRating() const { return table->numbers[(size_t)index].avgRating; }
+
+		int getNumTags() const { return (int)(table->tagStarts[(size_t)index + 1] - table->tagStarts[(size_t)index]); }
+		const String& getTag(int tagIndex) const { return table->getInterned(table->tagIds[table->tagStarts[(size_t)index] + (size_t)tagIndex]); }
+		StringArray getTags() const;
+
+		/** \brief	The high quality OGG preview, empty if the response had no previews */
+		String getOGGPreviewURL() const;
+
+		/** \brief	Builds an FSSound from this row */
+		FSSound toSound() const;
+
+	private:
+		const FSSoundTable* table;
+		int index;
+	};
+
+	FSSoundTable() = default;
+
+	/** \brief	A table holding the given sounds, in order */
+	explicit FSSoundTable(const Array<FSSound>& sounds);
+
+	int size() const { return (int)ids.size(); }
+	bool isEmpty() const { return ids.empty(); }
+	Row operator[](int rowIndex) const { jassert(isPositiveAndBelow(rowIndex, size())); return Row(*this, rowIndex); }
+
+	/**
+	 * \fn	void FSSoundTable::add(const FSSound& sound);
+	 *
+	 * \brief	Appends a sound. Kept: id, name, description, username, license, type,
+	 *			tags, duration, the numeric fields and the high quality OGG preview.
+	 */
+
+	void add(const FSSound& sound);
+
+	/** \brief	Appends a row of another table */
+	void add(const Row& row);
+
+	/** \brief	The first row with this sound ID, or -1 */
+	int indexOf(int64 soundId) const;
+
+	void clear();
+	void reserve(int numRows);
+
+	/** \brief	Builds FSSounds for all rows, or for the given rows in that order */
+	Array<FSSound> toArrayOfSounds() const;
+	Array<FSSound> toArrayOfSounds(const Array<int>& rowIndices) const;
+
+	/** \brief	Total number of results of the query, when the table came from one response */
+	int getTotalCount() const { return totalCount; }
+	String getNextPage() const { return nextPage; }
+
+	/** \brief	Bytes held by the table, roughly */
+	size_t getMemoryUsage() const;
+
+private:
+	friend class FSSoundListDecoder;
+
+	struct TextSpan {
+		uint32 start = 0;
+		uint32 length = 0;
+	};
+
+	struct Numbers {
+		int32 filesize = 0;
+		int32 samplerate = 0;
+		int32 bitrate = 0;
+		int32 numDownloads = 0;
+		int32 numRatings = 0;
+		float avgRating = 0.0f;
+		uint8 channels = 0;
+		uint8 bitdepth = 0;
+	};
+
+	void addRow(const FSSound& sound, float duration);
+	uint32 intern(const String& text);
+	const String& getInterned(uint32 internedIndex) const { return interned.getReference((int)internedIndex); }
+	TextSpan addText(const String& text);
+	String getText(TextSpan span) const;
+
+	std::vector<int64> ids;
+	std::vector<float> durations;
+	std::vector<Numbers> numbers;
+	std::vector<uint32> users, licenses, formats;
+	std::vector<TextSpan> names, descriptions;
+
+	/** \brief	Tags of row i are tagIds[tagStarts[i]] to tagIds[tagStarts[i + 1]] */
+	std::vector<uint32> tagIds;
+	std::vector<uint32> tagStarts { 0 };
+
+	/** \brief	Preview URLs split at the last slash: the folder is interned */
+	std::vector<uint32> previewFolders;
+	std::vector<TextSpan> previewFiles;
+
+	std::string text;
+	StringArray interned;
+	std::map<String, uint32> internedIndices;
+
+	int totalCount = 0;
+	String nextPage;
+};
+
+/**
+ * \class	FSSoundListDecoder
+ *
+ * \brief	Decodes a sound list response as it arrives, without building the whole
+ *			response as a String and then a var tree first. Each sound is written
+ *			straight into an FSSound, and only the fields the response holds are
+ *			touched: the rest of the input is skipped without being stored.
+ */
+
+class FSSoundListDecoder {
+public:
+
+	/**
+	 * \fn	static bool FSSoundListDecoder::decode(InputStream& input, SoundList& result);
+	 *
+	 * \brief	Reads a sound list response from input, which is read in blocks until
+	 *			the list ends
+	 *
+	 * \param 		  	input 	The response body.
+	 * \param [out]	result	The list, left untouched if the input isn't a valid response.
+	 *
+	 * \returns	True if the response was read completely.
+	 */
+
+	static bool decode(InputStream& input, SoundList& result);
+
+	/**
+	 * \fn	static bool FSSoundListDecoder::decode(InputStream& input, FSSoundTable& result);
+	 *
+	 * \brief	Reads a sound list response into a table, replacing what it held
+	 */
+
+	static bool decode(InputStream& input, FSSoundTable& result);
+
+	/**
+	 * \fn	static String FSSoundListDecoder::benchmark(const MemoryBlock& body, int numRuns = 5);
+	 *
+	 * \brief	Decodes the same response with JSON::parse and toArrayOfSounds(), then with
+	 *			decode(), and reports the average time and the heap each one needed
+	 *			(where the platform can tell)
+	 *
+	 * \param	body   	A sound list response.
+	 * \param	numRuns	(Optional) How many times each is timed.
+	 */
+
+	static String benchmark(const MemoryBlock& body, int numRuns = 5);
+};
+
+/**
+ * \class	FSResponseCache
+ *
+ * \brief	Cache of API responses, shared by every request in the process. GET
+ *			requests to read-only endpoints are answered from memory (least recently
+ *			used first out) or from disk while they're fresh. How long that is
+ *			depends on the endpoint: searches change quickly, a sound's metadata and
+ *			analysis hardly ever. Stale responses are revalidated with the ETag and
+ *			Last-Modified the server sent, and are used as they are when the server
+ *			can't be reached.
+ *
+ *			Entries are keyed by the URL with its parameters in a fixed order and by
+ *			the credentials used, so users never see each other's responses.
+ */
+
+class FSResponseCache : public DeletedAtShutdown {
+public:
+
+	/** \brief	A cached response and what's needed to revalidate it */
+	struct Entry {
+		String key;
+		var response;			// void until someone parsed the body into a var
+		String body;
+		String eTag;
+		String lastModified;
+		int64 storedAt = 0;		// milliseconds since 1970
+		int64 expiresAt = 0;
+
+		bool isFresh() const { return Time::currentTimeMillis() < expiresAt; }
+	};
+
+	FSResponseCache();
+	~FSResponseCache() override;
+
+	/**
+	 * \fn	static String FSResponseCache::makeKey(const URL& url, const String& authHeader);
+	 *
+	 * \brief	The cache key for a request
+	 *
+	 * \param	url		  	The full URL, parameters included.
+	 * \param	authHeader	The authorization header sent with it, if any.
+	 */
+
+	static String makeKey(const URL& url, const String& authHeader);
+
+	/**
+	 * \fn	static RelativeTime FSResponseCache::getTimeToLive(const URL& url);
+	 *
+	 * \brief	How long a response from this URL stays fresh. Zero for endpoints
+	 *			that are never cached (the user's own data, and anything that changes it).
+	 */
+
+	static RelativeTime getTimeToLive(const URL& url);
+
+	/** \brief	Finds an entry, fresh or stale, in memory or on disk */
+	bool lookup(const String& key, Entry& result);
+
+	/** \brief	Stores a successful response, if its endpoint is cacheable */
+	void store(const String& key, const URL& url, const var& response, const String& body,
+			   const String& eTag, const String& lastModified);
+
+	/** \brief	Marks an entry fresh again after the server answered 304 Not Modified */
+	void refresh(Entry& entry, const URL& url);
+
+	/** \brief	Where entries are kept on disk; an empty File keeps them in memory only */
+	void setDiskCacheFolder(const File& folder);
+
+	/** \brief	Drops every entry, in memory and on disk */
+	void clear();
+
+	/** \brief	Limits for the memory and disk tiers. The memory tier counts the
+				parsed var as well as the body, the disk tier only the body. */
+	static constexpr int64 maxMemoryBytes = 16 * 1024 * 1024;
+	static constexpr int64 maxDiskBytes = 128 * 1024 * 1024;
+
+	JUCE_DECLARE_SINGLETON(FSResponseCache, false)
+
+private:
+	struct MemoryEntry {
+		Entry entry;
+		int64 size = 0;			// as counted when it was added
+		uint64 lastUsed = 0;
+	};
+
+	void addToMemory(const Entry& entry);
+	static int64 estimateSize(const var& value);
+	bool readFromDisk(const String& key, Entry& result);
+	void writeToDisk(const Entry& entry);
+	void trimDiskCache();
+	File getDiskFile(const String& key) const;
+
+	CriticalSection lock;
+	std::map<String, MemoryEntry> memory;
+	int64 memoryBytes = 0;
+	uint64 useCounter = 0;
+
+	File diskFolder;
+	int writesSinceTrim = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(FSResponseCache)
+};
+
+/**
+ * \class	FSCancellationToken
+ *
+ * \brief	Lets a request made on another thread be stopped. While an asynchronous
+ *			call runs, its token is the current one for that thread, and every
+ *			FSRequest made by the call checks it: a cancelled token stops a request
+ *			that is connecting or reading, and fails the ones that haven't started.
+ */
+
+class FSCancellationToken {
+public:
+
+	/**
+	 * \fn	void FSCancellationToken::cancel();
+	 *
+	 * \brief	Stops the request in flight, if any. Can be called from any thread.
+	 */
+
+	void cancel();
+
+	/**
+	 * \fn	bool FSCancellationToken::isCancelled() const;
+	 *
+	 * \brief	Query if cancel() was called
+	 */
+
+	bool isCancelled() const { return cancelled.load(); }
+
+	/**
+	 * \fn	static FSCancellationToken* FSCancellationToken::getCurrent();
+	 *
+	 * \brief	The token of the asynchronous call running on this thread
+	 *
+	 * \returns	The token, or nullptr on threads that aren't running one.
+	 */
+
+	static FSCancellationToken* getCurrent();
+
+	/** \brief	Makes a token the current one for this thread while it's in scope */
+	struct ScopedCurrent {
+		explicit ScopedCurrent(FSCancellationToken& token);
+		~ScopedCurrent();
+		FSCancellationToken* previous;
+	};
+
+private:
+	friend class FSRequest;
+
+	/** \brief	Registers the stream cancel() must stop; false if already cancelled */
+	bool attachStream(WebInputStream* stream);
+	void detachStream();
+
+	std::atomic<bool> cancelled { false };
+	CriticalSection streamLock;
+	WebInputStream* activeStream = nullptr;
+};
+
+/**
+ * \class	FSFuture
+ *
+ * \brief	The result of an asynchronous FreesoundClient call. Copies share the same
+ *			call, so any of them can cancel it or add continuations.
+ *
+ *			Continuations added with then() are called on the message thread once the
+ *			result is in, also when it already was. After cancel() none are called,
+ *			so a component can capture itself in one as long as it cancels the call
+ *			before it goes away.
+ */
+
+template <typename ResultType>
+class FSFuture {
+public:
+	/** \brief	Defines an alias representing a continuation, called with the result */
+	typedef std::function<void(const ResultType&)> Continuation;
+
+	/**
+	 * \fn	FSFuture::FSFuture();
+	 *
+	 * \brief	An empty future, not attached to any call
+	 */
+
+	FSFuture() = default;
+
+	/** \brief	Query if this future is attached to a call */
+	bool isValid() const { return state != nullptr; }
+
+	/** \brief	Query if the call has finished */
+	bool isReady() const { return state != nullptr && state->finished.wait(0); }
+
+	/** \brief	Query if the call was cancelled */
+	bool isCancelled() const { return state != nullptr && state->isCancelled(); }
+
+	/**
+	 * \fn	void FSFuture::cancel();
+	 *
+	 * \brief	Stops the call's network traffic and drops its continuations. Does
+	 *			nothing on an empty future.
+	 */
+
+	void cancel() {
+		if (state != nullptr)
+			state->cancel();
+	}
+
+	/**
+	 * \fn	ResultType FSFuture::get() const;
+	 *
+	 * \brief	Waits for the result. Meant for background threads: on the message
+	 *			thread, use then() instead.
+	 *
+	 * \returns	The result, or a default constructed one if the call was cancelled.
+	 */
+
+	ResultType get() const {
+		if (state == nullptr)
+			return ResultType();
+
+		state->finished.wait();
+		const ScopedLock sl(state->lock);
+		return state->result;
+	}
+
+	/**
+	 * \fn	const FSFuture& FSFuture::then(Continuation continuation) const;
+	 *
+	 * \brief	Adds a function to call on the message thread with the result
+	 *
+	 * \param	continuation	The function.
+	 *
+	 * \returns	This future, so calls can be chained.
+	 */
+
+	const FSFuture& then(Continuation continuation) const {
+		if (state == nullptr || state->isCancelled())
+			return *this;
+
+		bool alreadyFinished;
+		{
+			const ScopedLock sl(state->lock);
+			state->continuations.push_back(std::move(continuation));
+			alreadyFinished = state->hasResult;
+		}
+
+		if (alreadyFinished)
+			deliverLater(state);
+
+		return *this;
+	}
+
+private:
+	friend class FreesoundClient;
+
+	struct State : public FSCancellationToken {
+		CriticalSection lock;
+		WaitableEvent finished { true };
+		ResultType result {};
+		bool hasResult = false;
+		std::vector<Continuation> continuations;
+	};
+
+	explicit FSFuture(std::shared_ptr<State> newState) : state(std::move(newState)) {}
+
+	static void finish(const std::shared_ptr<State>& state, ResultType result) {
+		{
+			const ScopedLock sl(state->lock);
+			state->result = std::move(result);
+			state->hasResult = true;
+		}
+
+		state->finished.signal();
+		deliverLater(state);
+	}
+
+	static void deliverLater(const std::shared_ptr<State>& state) {
+		MessageManager::callAsync([state] {
+			std::vector<Continuation> toCall;
+			{
+				const ScopedLock sl(state->lock);
+				toCall.swap(state->continuations);
+			}
+
+			// Checked on the message thread, where cancel() is normally called
+			for (auto& continuation : toCall)
+				if (!state->isCancelled())
+					continuation(state->result);
+		});
+	}
+
+	std::shared_ptr<State> state;
+};
+
+/**
+ * \class	FSRequestPool
+ *
+ * \brief	The threads asynchronous calls run on, shared by every FreesoundClient in
+ *			the process. The pool is small, so a burst of calls queues up instead of
+ *			opening dozens of connections at once.
+ *
+ *			It lives until shutdown rather than with the clients that use it: a call
+ *			is often made on a temporary client, and the pool must outlast it to run
+ *			the call at all.
+ */
+
+class FSRequestPool : public ThreadPool, public DeletedAtShutdown {
+public:
+	/** \brief	Number of requests in flight at once */
+	static constexpr int maxConcurrentRequests = 4;
+
+	FSRequestPool() : ThreadPool(maxConcurrentRequests) {}
+	~FSRequestPool() override;
+
+	JUCE_DECLARE_SINGLETON(FSRequestPool, false)
+
+	JUCE_DECLARE_NON_COPYABLE(FSRequestPool)
 };
 
 /**
@@ -598,6 +1119,10 @@ public:
 	String header;
 	/** \brief	The authentication type*/
 	Authorization auth;
+	/** \brief	How long a request may take to connect, in milliseconds */
+	int requestTimeoutMs = 10000;
+	/** \brief	Whether GET requests go through the shared FSResponseCache */
+	bool useResponseCache = true;
 
 
 	/**
@@ -707,6 +1232,44 @@ public:
 
 	SoundList textSearch(String query, String filter=String(), String sort="score", int groupByPack=0, int page=-1, int pageSize=-1, String fields = String(), String descriptors = String(), int normalized=0);
 
+	/**
+	 * \fn	FSSoundTable FreesoundClient::textSearchAsTable(String query, String filter=String(), String sort="score", int groupByPack=0, int page=-1, int pageSize=-1, String fields = String(), String descriptors = String(), int normalized=0);
+	 *
+	 * \brief	The same search as textSearch(), with the results in an FSSoundTable. Use
+	 *			it to hold many candidates, and build FSSounds only for the ones picked.
+	 *
+	 * \returns	A table with the text search results, empty if the search failed.
+	 */
+
+	FSSoundTable textSearchAsTable(String query, String filter=String(), String sort="score", int groupByPack=0, int page=-1, int pageSize=-1, String fields = String(), String descriptors = String(), int normalized=0);
+
+	/**
+	 * \fn	FSSoundTable FreesoundClient::textSearchSample(String query, int numSounds, int64 seed, String filter=String(), String sort="score", int groupByPack=0, String fields = String());
+	 *
+	 * \brief	Picks numSounds different sounds at random from all the results of a text
+	 *			search, without downloading them all. A one-result request gives the
+	 *			number of results, then a few pages chosen at random are fetched in
+	 *			parallel, each just big enough to make up numSounds between them.
+	 *			If duplicates, the short last page or failed pages leave it short,
+	 *			more pages are fetched until it has numSounds or runs out of pages.
+	 *			Blocks until they're all in, so call it from a background thread.
+	 *
+	 *			The same seed picks the same pages and the same order for as long as
+	 *			the search returns the same results.
+	 *
+	 * \param	query	   	The text query.
+	 * \param	numSounds  	How many sounds to pick. Fewer come back if the search has fewer results.
+	 * \param	seed	   	The seed for the random choices.
+	 * \param	filter	   	(Optional) Allows filtering query results.
+	 * \param	sort	   	(Optional) Indicates how query results should be sorted.
+	 * \param	groupByPack	(Optional) Whether to group sounds of the same pack in a single result.
+	 * \param	fields	   	(Optional) Indicates which sound properties should be included in every sound.
+	 *
+	 * \returns	The sounds picked, in random order, empty if the search failed.
+	 */
+
+	FSSoundTable textSearchSample(String query, int numSounds, int64 seed, String filter=String(), String sort="score", int groupByPack=0, String fields = String());
+
 	/**
 	 * \fn	SoundList FreesoundClient::contentSearch(String target, String descriptorsFilter=String(), int page = -1, int pageSize = -1, String fields = String(), String descriptors = String(), int normalized = 0);
 	 *
@@ -1197,7 +1760,93 @@ public:
 
 	String getClientID();
 
+	/**
+	 * \fn	template <typename ResultType> FSFuture<ResultType> FreesoundClient::runAsync(std::function<ResultType(FreesoundClient&)> call);
+	 *
+	 * \brief	Runs any blocking call, or series of calls, on the shared request pool.
+	 *			The function gets its own copy of this client. Requests it makes stop
+	 *			when the returned future is cancelled, and return an empty response.
+	 *
+	 * \param	call	The function to run.
+	 *
+	 * \returns	A future for the function's result.
+	 */
+
+	template <typename ResultType>
+	FSFuture<ResultType> runAsync(std::function<ResultType(FreesoundClient&)> call) {
+		auto state = std::make_shared<typename FSFuture<ResultType>::State>();
+
+		FreesoundClient worker(*this);
+
+		getRequestPool().addJob([state, worker, call]() mutable {
+			ResultType result {};
+
+			if (!state->isCancelled()) {
+				FSCancellationToken::ScopedCurrent current(*state);
+				result = call(worker);
+			}
+
+			FSFuture<ResultType>::finish(state, std::move(result));
+		});
+
+		return FSFuture<ResultType>(state);
+	}
+
+	/**
+	 * Asynchronous versions of the calls above. They take the same parameters,
+	 * return at once, and run the request on the shared request pool. Use
+	 * FSFuture::then() to get the result on the message thread, and
+	 * FSFuture::cancel() to abandon it.
+	 *
+	 * The calls that return nothing give true once the request has been made. The
+	 * authorization calls change the client itself, so they have no asynchronous
+	 * version, and downloads are already asynchronous.
+	 */
+
+	FSFuture<SoundList> textSearchAsync(String query, String filter=String(), String sort="score", int groupByPack=0, int page=-1, int pageSize=-1, String fields = String(), String descriptors = String(), int normalized=0);
+	FSFuture<FSSoundTable> textSearchAsTableAsync(String query, String filter=String(), String sort="score", int groupByPack=0, int page=-1, int pageSize=-1, String fields = String(), String descriptors = String(), int normalized=0);
+	FSFuture<FSSoundTable> textSearchSampleAsync(String query, int numSounds, int64 seed, String filter=String(), String sort="score", int groupByPack=0, String fields = String());
+	FSFuture<SoundList> contentSearchAsync(String target, String descriptorsFilter=String(), int page = -1, int pageSize = -1, String fields = String(), String descriptors = String(), int normalized = 0);
+	FSFuture<FSList> fetchNextPageAsync(FSList fslist);
+	FSFuture<FSList> fetchPreviousPageAsync(FSList fslist);
+	FSFuture<SoundList> fetchNextPageAsync(SoundList fslist);
+	FSFuture<SoundList> fetchPreviousPageAsync(SoundList fslist);
+	FSFuture<FSSound> getSoundAsync(String id, String fields = String());
+	FSFuture<var> getSoundAnalysisAsync(String id, String descriptors = String(), int normalized = 0);
+	FSFuture<SoundList> getSimilarSoundsAsync(String id, String descriptorsFilter = String(), int page = -1, int pageSize = -1, String fields = String(), String descriptors = String(), int normalized = 0);
+	FSFuture<int> uploadSoundAsync(const File &fileToUpload, String tags, String description, String name = String(), String license = "Creative Commons 0", String pack = String(), String geotag = String());
+	FSFuture<int> describeSoundAsync(String uploadFilename, String description, String license, String name = String(), String tags = String(), String pack = String(), String geotag = String());
+	FSFuture<var> pendingUploadsAsync();
+	FSFuture<bool> editSoundDescriptionAsync(String id, String name = String(), String tags = String(), String description = String(), String license = String(), String pack = String(), String geotag = String());
+	FSFuture<bool> bookmarkSoundAsync(String id, String name = String(), String category = String());
+	FSFuture<bool> rateSoundAsync(String id, int rating);
+	FSFuture<bool> commentSoundAsync(String id, String comment);
+	FSFuture<FSUser> getUserAsync(String user);
+	FSFuture<SoundList> getUserSoundsAsync(String username, String descriptorsFilter = String(), int page = -1, int pageSize = -1, String fields = String(), String descriptors = String(), int normalized = 0);
+	FSFuture<FSList> getUserBookmarkCategoriesAsync(String username);
+	FSFuture<FSList> getUserBookmarkCategoriesSoundsAsync(String username, String bookmarkCategory);
+	FSFuture<FSList> getUserPacksAsync(String username);
+	FSFuture<FSPack> getPackAsync(String id);
+	FSFuture<SoundList> getPackSoundsAsync(String id, String descriptorsFilter = String(), int page = -1, int pageSize = -1, String fields = String(), String descriptors = String(), int normalized = 0);
+	FSFuture<FSUser> getMeAsync();
+
+	/**
+	 * \fn	String FreesoundClient::benchmarkSoundListDecoding(String query, String filter = String(), String fields = String(), int pageSize = -1);
+	 *
+	 * \brief	Downloads one text search page and runs FSSoundListDecoder::benchmark() on it.
+	 *			Blocks, so call it from a background thread.
+	 *
+	 * \returns	The benchmark's report, or why there was nothing to measure.
+	 */
 
+	String benchmarkSoundListDecoding(String query, String filter = String(), String fields = String(), int pageSize = -1);
+
+	/** \brief	Most pages textSearchSample() fetches, and the largest page the API serves */
+	static constexpr int maxSamplePages = 4;
+	static constexpr int maxPageSize = 150;
+
+private:
+	static ThreadPool& getRequestPool();
 };
 
 /**
@@ -1334,10 +1983,56 @@ public:
 
 	Response request(StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
 
+	/**
+	 * \fn	int FSRequest::requestSounds(SoundList& result, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+	 *
+	 * \brief	Make a request whose response is a sound list, decoding it with
+	 *			FSSoundListDecoder while it downloads
+	 *
+	 * \param [out]	result		   	The list, left empty if the request fails.
+	 * \param 		  	params		   	(Optional) The parameters for the request.
+	 * \param 		  	data		   	(Optional) The data if any.
+	 * \param 		  	postLikeRequest	(Optional) If a POST like request is desired.
+	 *
+	 * \returns The status code of the response, or -1 if the body couldn't be decoded.
+	 */
+
+	int requestSounds(SoundList& result, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+
+	/**
+	 * \fn	int FSRequest::requestSoundTable(FSSoundTable& result, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+	 *
+	 * \brief	Like requestSounds(), decoding into a table
+	 *
+	 * \returns The status code of the response, or -1 if the body couldn't be decoded.
+	 */
+
+	int requestSoundTable(FSSoundTable& result, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+
+	/**
+	 * \fn	int FSRequest::requestBody(MemoryBlock& body, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+	 *
+	 * \brief	Make a request and keep the response body as it arrived, undecoded.
+	 *			Error responses leave body untouched.
+	 *
+	 * \returns The status code of the response, or -1 if the body couldn't be read.
+	 */
+
+	int requestBody(MemoryBlock& body, StringPairArray params = StringPairArray(), String data = String(), bool postLikeRequest = true);
+
 private:
+	/** \brief	Reads a response body. The var holds the cached parse of it, if there is
+				one, and what's left in it is cached with the body. */
+	typedef std::function<bool(InputStream& body, var& parsed)> BodyConsumer;
+
+	/** \brief	Sends the request, or answers it from the cache, and hands the body to consume.
+				Non-2xx bodies only reach it with consumeErrorBody. Returns -1 for a 2xx
+				response it couldn't read. */
+	int fetch(const StringPairArray& params, const String& data, bool postLikeRequest, bool consumeErrorBody, const BodyConsumer& consume);
+
 	/** \brief	The URI of the rrequest */
 	URL uri;
-	/** \brief	The client used*/
-	FreesoundClient& client;
+	/** \brief	The client used (a copy, so a request can outlive the caller's client) */
+	FreesoundClient client;
 };
 
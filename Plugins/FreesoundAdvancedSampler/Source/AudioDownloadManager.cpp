@@ -1,191 +1,146 @@
 #include "AudioDownloadManager.h"
 
-AudioDownloadManager::AudioDownloadManager() : juce::Thread("AudioDownloader")
+AudioDownloadManager::AudioDownloadManager()
 {
 }
 
 AudioDownloadManager::~AudioDownloadManager()
 {
-    stopThread(2000);
+    cancelDownloads();
+}
+
+void AudioDownloadManager::setMaxConcurrentDownloads(int numWorkers)
+{
+    scheduler->setMaxConcurrentDownloads(numWorkers);
 }
 
 void AudioDownloadManager::startDownloads(const juce::Array<FSSound>& sounds, const juce::File& downloadDirectory, const juce::String& searchQuery)
 {
-    if (isThreadRunning())
-        stopThread(2000);
+    // Add the new batch before dropping the old one, so sounds the two have in
+    // common carry on downloading instead of starting over
+    const auto previousRequest = currentRequest;
 
-    soundsToDownload = sounds;
-    targetDirectory = downloadDirectory;
     currentSearchQuery = searchQuery;
-    currentDownloadIndex = 0;
+    currentProgress = DownloadProgress();
+    currentProgress.totalFiles = sounds.size();
 
+    for (const auto& sound : sounds)
     {
-        juce::ScopedLock lock(progressLock);
-        currentProgress.totalFiles = sounds.size();
-        currentProgress.completedFiles = 0;
-        currentProgress.currentFileDownloaded = 0;
-        currentProgress.currentFileTotal = 0;
-        currentProgress.overallProgress = 0.0f;
-        currentProgress.currentFileName = "";
+        FileProgress file;
+        file.freesoundId = sound.id;
+        file.file = DownloadScheduler::getFileForSound(sound.id, downloadDirectory);
+        file.fileName = file.file.getFileName();
+        currentProgress.files.add(file);
     }
 
-    targetDirectory.createDirectory();
-    startThread();
-    startTimer(100); // Update UI every 100ms
+    currentRequest = scheduler->addRequest(sounds, downloadDirectory, this, priority);
+
+    if (previousRequest != 0)
+        scheduler->cancelRequest(previousRequest);
 }
 
-void AudioDownloadManager::run()
+void AudioDownloadManager::cancelDownloads()
 {
-    bool allSuccessful = true;
-    juce::Array<DownloadedFileInfo> downloadedFiles;
+    if (currentRequest != 0)
+        scheduler->cancelRequest(currentRequest);
 
-    for (int i = 0; i < soundsToDownload.size() && !threadShouldExit(); ++i)
-    {
-        currentDownloadIndex = i;
-        juce::URL url = soundsToDownload[i].getOGGPreviewURL();
+    currentRequest = 0;
+}
 
-        if (url.isEmpty())
-            continue;
+void AudioDownloadManager::setPriority(DownloadScheduler::Priority newPriority)
+{
+    priority = newPriority;
 
-        // Create filename using just Freesound ID: FS_ID_XXXX.ogg
-        juce::String fileName = "FS_ID_" + juce::String(soundsToDownload[i].id) + ".ogg";
-        currentOutputFile = targetDirectory.getChildFile(fileName);
-
-        {
-            juce::ScopedLock lock(progressLock);
-            currentProgress.currentFileName = fileName;
-            currentProgress.currentFileDownloaded = 0;
-            currentProgress.currentFileTotal = 0;
-        }
-
-        // Create web input stream
-        juce::URL downloadUrl = url;
-        currentStream = std::make_unique<juce::WebInputStream>(downloadUrl, false);
-
-        if (currentStream->connect(nullptr))
-        {
-            // Get file size if available
-            int64 totalSize = currentStream->getTotalLength();
-
-            {
-                juce::ScopedLock lock(progressLock);
-                currentProgress.currentFileTotal = totalSize;
-            }
-
-            // Create output stream
-            std::unique_ptr<juce::FileOutputStream> output = currentOutputFile.createOutputStream();
-
-            if (output != nullptr)
-            {
-                const int bufferSize = 8192;
-                juce::HeapBlock<char> buffer(bufferSize);
-                int64 totalRead = 0;
-
-                while (!currentStream->isExhausted() && !threadShouldExit())
-                {
-                    int bytesRead = currentStream->read(buffer, bufferSize);
-
-                    if (bytesRead > 0)
-                    {
-                        output->write(buffer, bytesRead);
-                        totalRead += bytesRead;
-
-                        {
-                            juce::ScopedLock lock(progressLock);
-                            currentProgress.currentFileDownloaded = totalRead;
-                        }
-                    }
-                    else if (bytesRead == 0)
-                    {
-                        break; // End of stream
-                    }
-                    else
-                    {
-                        allSuccessful = false;
-                        break; // Error
-                    }
-                }
-
-                output->flush();
-
-                // Record successful download info
-                if (currentOutputFile.existsAsFile())
-                {
-                    DownloadedFileInfo fileInfo;
-                    fileInfo.fileName = fileName;
-                    fileInfo.originalName = soundsToDownload[i].name; // Get original name from the sound object
-                    fileInfo.freesoundId = soundsToDownload[i].id;
-                    fileInfo.searchQuery = currentSearchQuery;
-                    fileInfo.author = soundsToDownload[i].user;
-                    fileInfo.license = soundsToDownload[i].license;
-                    fileInfo.duration = soundsToDownload[i].duration;
-                    fileInfo.fileSize = soundsToDownload[i].filesize;
-                    fileInfo.downloadedAt = juce::Time::getCurrentTime().toString(true, true);
-                    fileInfo.padIndex = i; // Store original download order
-                    downloadedFiles.add(fileInfo);
-                }
-            }
-            else
-            {
-                allSuccessful = false;
-            }
-        }
-        else
-        {
-            allSuccessful = false;
-        }
-
-        currentStream.reset();
-
-        {
-            juce::ScopedLock lock(progressLock);
-            currentProgress.completedFiles = i + 1;
-        }
-    }
+    if (currentRequest != 0)
+        scheduler->setRequestPriority(currentRequest, priority);
+}
 
-    stopTimer();
+bool AudioDownloadManager::isDownloading() const
+{
+    return currentRequest != 0 && scheduler->isRequestActive(currentRequest);
+}
 
-    // Final progress update
+void AudioDownloadManager::downloadRequestProgress(DownloadScheduler::RequestID requestId,
+                                                   const juce::Array<DownloadScheduler::FileState>& files)
+{
+    if (requestId != currentRequest)
+        return;
+
+    auto& progress = currentProgress;
+    progress.completedFiles = 0;
+    progress.activeDownloads = 0;
+    progress.currentFileDownloaded = 0;
+    progress.currentFileTotal = 0;
+
+    // Calculate overall progress: finished files count fully, files in flight
+    // by the fraction downloaded so far
+    float activeProgress = 0.0f;
+
+    for (int i = 0; i < files.size() && i < progress.files.size(); ++i)
     {
-        juce::ScopedLock lock(progressLock);
-        currentProgress.overallProgress = 1.0f;
-        currentProgress.currentFileName = allSuccessful ? "All downloads completed!" : "Some downloads failed";
+        const auto& state = files.getReference(i);
+        auto& file = progress.files.getReference(i);
+
+        if (state.isActive && !file.isActive)
+            progress.currentFileName = file.fileName;
+
+        file.downloaded = state.downloaded;
+        file.total = state.total;
+        file.isActive = state.isActive;
+        file.isFinished = state.isFinished;
+        file.failed = state.failed;
+
+        if (file.isFinished)
+            ++progress.completedFiles;
+
+        if (!file.isActive)
+            continue;
+
+        ++progress.activeDownloads;
+        progress.currentFileDownloaded += file.downloaded;
+        progress.currentFileTotal += file.total;
+
+        if (file.total > 0)
+            activeProgress += juce::jmin(1.0f, (float)file.downloaded / (float)file.total);
     }
-    updateProgress();
 
-    listeners.call([allSuccessful](Listener& l) { l.downloadCompleted(allSuccessful); });
+    if (progress.totalFiles > 0)
+        progress.overallProgress = juce::jmin(1.0f, ((float)progress.completedFiles + activeProgress) / (float)progress.totalFiles);
+
+    listeners.call([this](Listener& l) { l.downloadProgressChanged(currentProgress); });
 }
 
-void AudioDownloadManager::timerCallback()
+void AudioDownloadManager::downloadRequestFileFinished(DownloadScheduler::RequestID requestId,
+                                                       const DownloadScheduler::FileState& state)
 {
-    updateProgress();
+    if (requestId != currentRequest)
+        return;
+
+    FileProgress file;
+    file.fileName = state.file.getFileName();
+    file.freesoundId = state.freesoundId;
+    file.file = state.file;
+    file.downloaded = state.downloaded;
+    file.total = state.total;
+    file.isFinished = true;
+    file.failed = state.failed;
+
+    listeners.call([&file](Listener& l) { l.downloadFileCompleted(file); });
 }
 
-void AudioDownloadManager::updateProgress()
+void AudioDownloadManager::downloadRequestFinished(DownloadScheduler::RequestID requestId, bool success)
 {
-    DownloadProgress progress;
-    {
-        juce::ScopedLock lock(progressLock);
-        progress = currentProgress;
-    }
-
-    // Calculate overall progress
-    if (progress.totalFiles > 0)
-    {
-        float filesProgress = (float)progress.completedFiles / (float)progress.totalFiles;
-        float currentFileProgress = 0.0f;
+    if (requestId != currentRequest)
+        return;
 
-        if (progress.currentFileTotal > 0)
-        {
-            currentFileProgress = (float)progress.currentFileDownloaded / (float)progress.currentFileTotal;
-            currentFileProgress /= (float)progress.totalFiles; // Weight by total files
-        }
+    currentRequest = 0;
 
-        progress.overallProgress = filesProgress + currentFileProgress;
-        progress.overallProgress = juce::jmin(1.0f, progress.overallProgress);
-    }
+    // Final progress update
+    currentProgress.overallProgress = 1.0f;
+    currentProgress.currentFileName = success ? "All downloads completed!" : "Some downloads failed";
+    listeners.call([this](Listener& l) { l.downloadProgressChanged(currentProgress); });
 
-    listeners.call([progress](Listener& l) { l.downloadProgressChanged(progress); });
+    listeners.call([success](Listener& l) { l.downloadCompleted(success); });
 }
 
 void AudioDownloadManager::addListener(Listener* listener)
@@ -196,4 +151,4 @@ void AudioDownloadManager::addListener(Listener* listener)
 void AudioDownloadManager::removeListener(Listener* listener)
 {
     listeners.remove(listener);
-}
\ No newline at end of file
+}
@@ -2,19 +2,36 @@
 
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
 #include "FreesoundAPI/FreesoundAPI.h"
+#include "DownloadScheduler.h"
 
-class AudioDownloadManager : public juce::Thread,
-                           public juce::Timer
+// One caller's view of its downloads. The transfers themselves run on the
+// shared DownloadScheduler, so several managers can be busy at once and a
+// sound wanted by more than one of them is only fetched once.
+class AudioDownloadManager : private DownloadScheduler::Listener
 {
 public:
+    struct FileProgress
+    {
+        juce::String fileName;
+        juce::String freesoundId;
+        juce::File file;
+        int64 downloaded = 0;
+        int64 total = 0;        // 0 until the server reports a length
+        bool isActive = false;
+        bool isFinished = false;
+        bool failed = false;
+    };
+
     struct DownloadProgress
     {
         int totalFiles = 0;
         int completedFiles = 0;
-        int64 currentFileDownloaded = 0;
+        int activeDownloads = 0;
+        int64 currentFileDownloaded = 0;    // summed over the files in flight
         int64 currentFileTotal = 0;
         float overallProgress = 0.0f;
-        juce::String currentFileName;
+        juce::String currentFileName;       // most recently started file
+        juce::Array<FileProgress> files;    // same order as the sounds passed to startDownloads()
     };
 
     struct DownloadedFileInfo
@@ -31,35 +48,51 @@ public:
         int padIndex;
     };
 
+    // Called on the message thread
     class Listener
     {
     public:
         virtual ~Listener() = default;
         virtual void downloadProgressChanged(const DownloadProgress& progress) = 0;
         virtual void downloadCompleted(bool success) = 0;
+
+        // Each file as soon as it's done, before the rest of the batch
+        virtual void downloadFileCompleted(const FileProgress&) {}
     };
 
     AudioDownloadManager();
     ~AudioDownloadManager() override;
 
+    // Replaces this manager's previous batch, if any. Only files no other
+    // caller is waiting on are actually stopped.
     void startDownloads(const juce::Array<FSSound>& sounds, const juce::File& downloadDirectory, const juce::String& searchQuery);
+    void cancelDownloads();
+    bool isDownloading() const;
+
+    // Applies to the batch in flight and to later ones
+    void setPriority(DownloadScheduler::Priority newPriority);
+    DownloadScheduler::Priority getPriority() const { return priority; }
+
     void addListener(Listener* listener);
     void removeListener(Listener* listener);
 
+    // Number of files fetched at once, shared by every manager in the process
+    void setMaxConcurrentDownloads(int numWorkers);
+    int getMaxConcurrentDownloads() const { return scheduler->getMaxConcurrentDownloads(); }
+
+    static juce::File getPartFile(const juce::File& targetFile) { return DownloadScheduler::getPartFile(targetFile); }
+
 private:
-    void run() override;
-    void timerCallback() override;
-    void updateProgress();
+    void downloadRequestProgress(DownloadScheduler::RequestID, const juce::Array<DownloadScheduler::FileState>&) override;
+    void downloadRequestFileFinished(DownloadScheduler::RequestID, const DownloadScheduler::FileState&) override;
+    void downloadRequestFinished(DownloadScheduler::RequestID, bool success) override;
+
+    juce::SharedResourcePointer<DownloadScheduler> scheduler;
+    DownloadScheduler::RequestID currentRequest = 0;
+    DownloadScheduler::Priority priority = DownloadScheduler::Priority::Visible;
 
-    juce::Array<FSSound> soundsToDownload;
-    juce::File targetDirectory;
     juce::String currentSearchQuery;
     juce::ListenerList<Listener> listeners;
-    
+
     DownloadProgress currentProgress;
-    juce::CriticalSection progressLock;
-    
-    std::unique_ptr<juce::WebInputStream> currentStream;
-    juce::File currentOutputFile;
-    int currentDownloadIndex = 0;
-};
\ No newline at end of file
+};
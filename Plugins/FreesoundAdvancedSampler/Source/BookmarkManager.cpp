@@ -1,4 +1,5 @@
 #include "BookmarkManager.h"
+#include "SampleStore.h"
 
 BookmarkManager::BookmarkManager(const File& baseDirectory)
     : baseDirectory(baseDirectory)
@@ -111,6 +112,30 @@ BookmarkInfo BookmarkManager::getBookmark(const String& freesoundId) const
     return BookmarkInfo(); // Return empty if not found
 }
 
+bool BookmarkManager::getBookmarkedSampleIds(StringArray& ids) const
+{
+    if (!bookmarksFile.existsAsFile())
+        return true;
+    
+    var parsedJson = JSON::parse(bookmarksFile.loadFileAsString());
+    
+    if (!parsedJson.isObject())
+        return false;
+    
+    if (auto* bookmarksArray = parsedJson.getProperty("bookmarks", var()).getArray())
+    {
+        for (const auto& bookmarkVar : *bookmarksArray)
+        {
+            const String freesoundId = bookmarkVar.getProperty("freesound_id", "");
+            
+            if (freesoundId.isNotEmpty())
+                ids.add(freesoundId);
+        }
+    }
+    
+    return true;
+}
+
 Array<BookmarkInfo> BookmarkManager::loadBookmarks() const
 {
     Array<BookmarkInfo> bookmarks;
@@ -230,7 +255,7 @@ void BookmarkManager::cleanupMissingFiles()
     
     for (const auto& bookmark : bookmarks)
     {
-        File sampleFile = baseDirectory.getChildFile("samples").getChildFile(bookmark.fileName);
+        File sampleFile = SampleStore::getSampleFile(baseDirectory.getChildFile("samples"), bookmark.freesoundId);
         if (sampleFile.existsAsFile())
         {
             validBookmarks.add(bookmark);
@@ -36,6 +36,10 @@ public:
     Array<BookmarkInfo> getAllBookmarks() const;
     BookmarkInfo getBookmark(const String& freesoundId) const;
     
+    // Adds the bookmarked sample IDs. Returns false if the bookmarks file is
+    // there but can't be read, e.g. because it's being saved.
+    bool getBookmarkedSampleIds(StringArray& ids) const;
+    
     // File management
     File getBookmarksFile() const { return bookmarksFile; }
     void cleanupMissingFiles();
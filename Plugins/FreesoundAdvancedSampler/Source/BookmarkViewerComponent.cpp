@@ -34,12 +34,6 @@ BookmarkViewerComponent::BookmarkViewerComponent()
 
 BookmarkViewerComponent::~BookmarkViewerComponent()
 {
-    // Remove preview playback listener
-    if (processor)
-    {
-        processor->removePreviewPlaybackListener(this);
-    }
-
     clearBookmarkPads();
 }
 
@@ -76,19 +70,10 @@ void BookmarkViewerComponent::resized()
 
 void BookmarkViewerComponent::setProcessor(FreesoundAdvancedSamplerAudioProcessor* p)
 {
-    // Remove old listener if exists
-    if (processor)
-    {
-        processor->removePreviewPlaybackListener(this);
-    }
-
     processor = p;
 
     if (processor)
     {
-        // Add preview playback listener
-        processor->addPreviewPlaybackListener(this);
-
         // Initial load of bookmarks
         refreshBookmarks();
     }
@@ -192,30 +177,35 @@ void BookmarkViewerComponent::scrollBarMoved(ScrollBar* scrollBarThatHasMoved, d
 }
 
 //==============================================================================
-// PreviewPlaybackListener Implementation
+// Preview playback state
 //==============================================================================
 
-void BookmarkViewerComponent::previewStarted(const String& freesoundId)
+void BookmarkViewerComponent::updatePlaybackState(const PlaybackStateBoard& playbackState)
 {
-    if (auto* pad = findPadByFreesoundId(freesoundId))
-    {
-        pad->setPreviewPlaying(true);
-    }
-}
+    const auto state = playbackState.getState(PlaybackStateBoard::previewSlot);
 
-void BookmarkViewerComponent::previewStopped(const String& freesoundId)
-{
-    if (auto* pad = findPadByFreesoundId(freesoundId))
+    // A different sound started previewing: reset the pad that was showing
+    if (state.freesoundId != lastPreviewSoundId && lastPreviewSoundId != 0)
     {
-        pad->setPreviewPlaying(false);
+        if (auto* pad = findPadByFreesoundId(String(lastPreviewSoundId)))
+        {
+            pad->setPreviewPlaying(false);
+        }
     }
-}
 
-void BookmarkViewerComponent::previewPlayheadPositionChanged(const String& freesoundId, float position)
-{
-    if (auto* pad = findPadByFreesoundId(freesoundId))
+    lastPreviewSoundId = state.freesoundId;
+
+    if (state.freesoundId == 0)
+        return;
+
+    if (auto* pad = findPadByFreesoundId(String(state.freesoundId)))
     {
-        pad->setPreviewPlayheadPosition(position);
+        pad->setPreviewPlaying(state.isPlaying);
+
+        if (state.isPlaying)
+        {
+            pad->setPreviewPlayheadPosition(state.position);
+        }
     }
 }
 
@@ -18,8 +18,7 @@
 class FreesoundAdvancedSamplerAudioProcessorEditor;
 
 class BookmarkViewerComponent : public Component,
-                               public ScrollBar::Listener,
-                               public FreesoundAdvancedSamplerAudioProcessor::PreviewPlaybackListener
+                               public ScrollBar::Listener
 {
 public:
     BookmarkViewerComponent();
@@ -34,10 +33,8 @@ public:
     // ScrollBar::Listener
     void scrollBarMoved(ScrollBar* scrollBarThatHasMoved, double newRangeStart) override;
 
-    // PreviewPlaybackListener implementation
-    void previewStarted(const String& freesoundId) override;
-    void previewStopped(const String& freesoundId) override;
-    void previewPlayheadPositionChanged(const String& freesoundId, float position) override;
+    // Called by the editor once per frame with the processor's playback state
+    void updatePlaybackState(const PlaybackStateBoard& playbackState);
 
 private:
     FreesoundAdvancedSamplerAudioProcessor* processor;
@@ -51,6 +48,7 @@ private:
     // Sample pads for bookmarks (using unified SamplePad in Preview mode)
     OwnedArray<SamplePad> bookmarkPads;
     std::map<String, SamplePad*> bookmarkPadMap; // Map for quick access by Freesound ID
+    int64 lastPreviewSoundId = 0; // Sound shown as previewing last frame
 
     // Current bookmark data
     Array<BookmarkInfo> currentBookmarks;
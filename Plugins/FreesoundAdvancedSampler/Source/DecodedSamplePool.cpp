@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+    DecodedSamplePool.cpp
+    Created: Process-wide cache of decoded pad audio, keyed by Freesound ID
+             (and sample rate, for copies resampled to the host rate)
+
+  ==============================================================================
+*/
+
+#include "DecodedSamplePool.h"
+#include "SincResampler.h"
+
+DecodedSamplePool::DecodedSamplePool()
+    : decodeThreads(jmax(1, SystemStats::getNumCpus() - 1)),
+      decodeConcurrency(jlimit(1, 8, SystemStats::getNumCpus()))
+{
+    formatManager.registerBasicFormats();
+    startTimer(5000);
+}
+
+DecodedSamplePool::~DecodedSamplePool()
+{
+    stopTimer();
+}
+
+PadSample::Ptr DecodedSamplePool::getSample(const String& freesoundId, const File& audioFile,
+                                            double targetSampleRate)
+{
+    if (freesoundId.isEmpty())
+        return nullptr;
+
+    // Copies in different storage formats are pooled side by side, until the
+    // ones in the old format are no longer used
+    const auto storageToUse = storage.load();
+    const String nativeKey = freesoundId + (storageToUse == PadSample::Storage::Int16   ? "/i16"
+                                          : storageToUse == PadSample::Storage::Float16 ? "/f16"
+                                                                                         : "");
+
+    auto decodeNative = [&] { return decode(freesoundId, audioFile, storageToUse); };
+
+    if (targetSampleRate <= 0.0)
+        return getOrCreate(nativeKey, decodeNative);
+
+    const String key = nativeKey + "@" + String(roundToInt(targetSampleRate));
+
+    return getOrCreate(key, [&]() -> PadSample::Ptr
+    {
+        auto native = getOrCreate(nativeKey, decodeNative);
+
+        // Nothing to gain for streamed sounds: their tail plays at the file's rate anyway
+        if (native == nullptr || native->isStreamed() || native->getSampleRate() == targetSampleRate)
+            return native;
+
+        return resample(*native, targetSampleRate, storageToUse);
+    });
+}
+
+Array<PadSample::Ptr> DecodedSamplePool::getSamples(const Array<SampleRequest>& requests, double targetSampleRate,
+                                                   std::function<bool()> shouldStop)
+{
+    Array<PadSample::Ptr> results;
+    results.insertMultiple(0, nullptr, requests.size());
+
+    // Pads sharing a sound are fine here: the second job waits for the first
+    // one's decode in getOrCreate() instead of decoding it again
+    runInParallel(requests.size(), decodeConcurrency.load(), [&](int index)
+    {
+        const auto& request = requests.getReference(index);
+        results.set(index, getSample(request.freesoundId, request.audioFile, targetSampleRate));
+    }, shouldStop);
+
+    return results;
+}
+
+void DecodedSamplePool::setDecodeConcurrency(int numThreads)
+{
+    decodeConcurrency.store(jlimit(1, decodeThreads.getNumThreads() + 1, numThreads));
+}
+
+double DecodedSamplePool::timeDecode(const Array<SampleRequest>& requests, int numThreads)
+{
+    const auto storageToUse = storage.load();
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    runInParallel(requests.size(), jlimit(1, decodeThreads.getNumThreads() + 1, numThreads), [&](int index)
+    {
+        const auto& request = requests.getReference(index);
+        decode(request.freesoundId, request.audioFile, storageToUse);
+    }, {});
+
+    return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+}
+
+void DecodedSamplePool::runInParallel(int numJobs, int numThreads, const std::function<void(int)>& job,
+                                      const std::function<bool()>& shouldStop)
+{
+    struct Shared
+    {
+        std::atomic<int> nextJob { 0 };
+        std::atomic<int> helpersRunning { 0 };
+        WaitableEvent helpersDone { true };
+    };
+
+    // Shared by pointer: a helper may still be inside signal() when the wait
+    // below returns
+    auto shared = std::make_shared<Shared>();
+
+    auto work = [&]
+    {
+        for (;;)
+        {
+            if (shouldStop && shouldStop())
+                return;
+
+            const int index = shared->nextJob.fetch_add(1);
+
+            if (index >= numJobs)
+                return;
+
+            job(index);
+        }
+    };
+
+    const int numHelpers = jmin(numThreads - 1, numJobs - 1);
+    shared->helpersRunning.store(numHelpers);
+
+    if (numHelpers <= 0)
+        shared->helpersDone.signal();
+
+    for (int i = 0; i < numHelpers; ++i)
+    {
+        decodeThreads.addJob([shared, &work]
+        {
+            work();
+
+            if (--shared->helpersRunning == 0)
+                shared->helpersDone.signal();
+        });
+    }
+
+    // Helpers stuck behind another instance's decodes just find nothing left
+    // to do, but they still have to be waited for, since work() refers to
+    // this function's locals
+    work();
+    shared->helpersDone.wait();
+}
+
+void DecodedSamplePool::setStorage(PadSample::Storage newStorage)
+{
+    storage.store(newStorage);
+}
+
+PadSample::Storage DecodedSamplePool::getStorage() const
+{
+    return storage.load();
+}
+
+PadSample::Ptr DecodedSamplePool::getOrCreate(const String& key, const std::function<PadSample::Ptr()>& create)
+{
+    ReferenceCountedObjectPtr<PendingDecode> pending;
+
+    for (;;)
+    {
+        ReferenceCountedObjectPtr<PendingDecode> otherDecode;
+
+        {
+            const ScopedLock sl(lock);
+
+            if (samples.contains(key))
+                return samples[key];
+
+            if (pendingDecodes.contains(key))
+            {
+                otherDecode = pendingDecodes[key];
+            }
+            else
+            {
+                pending = new PendingDecode();
+                pendingDecodes.set(key, pending);
+                break;
+            }
+        }
+
+        // Someone else is decoding this sound already, use their result
+        otherDecode->finished.wait();
+    }
+
+    auto sample = create();
+
+    {
+        const ScopedLock sl(lock);
+
+        // Failed decodes aren't cached, the file may simply not be downloaded yet
+        if (sample != nullptr)
+            samples.set(key, sample);
+
+        pendingDecodes.remove(key);
+    }
+
+    pending->finished.signal();
+    return sample;
+}
+
+int DecodedSamplePool::getNumSamples() const
+{
+    const ScopedLock sl(lock);
+    return samples.size();
+}
+
+size_t DecodedSamplePool::getMemoryUsage() const
+{
+    const ScopedLock sl(lock);
+
+    size_t total = 0;
+
+    for (HashMap<String, PadSample::Ptr>::Iterator i(samples); i.next();)
+        total += i.getValue()->getSizeInBytes();
+
+    return total;
+}
+
+PadSample::Ptr DecodedSamplePool::decode(const String& freesoundId, const File& audioFile,
+                                         PadSample::Storage storageToUse)
+{
+    if (!audioFile.existsAsFile())
+        return nullptr;
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+        return nullptr;
+
+    const int64 totalLength = reader->lengthInSamples;
+    const int headLength = (int)jmin(totalLength, (int64)(headLengthSeconds * reader->sampleRate));
+    const int numChannels = jlimit(1, 2, (int)reader->numChannels);
+
+    AudioBuffer<float> head(numChannels, headLength + PadSample::paddingSamples);
+    head.clear();
+    reader->read(&head, 0, headLength, 0, true, numChannels > 1);
+
+    return new PadSample(freesoundId, std::move(head), headLength, totalLength,
+                         reader->sampleRate, audioFile, storageToUse);
+}
+
+PadSample::Ptr DecodedSamplePool::resample(const PadSample& sample, double targetSampleRate,
+                                           PadSample::Storage storageToUse)
+{
+    const auto startTime = Time::getMillisecondCounterHiRes();
+
+    int numFrames = 0;
+    auto audio = SincResampler::process(sample.getHeadAsFloat(), sample.getHeadLength(),
+                                        sample.getSampleRate(), targetSampleRate,
+                                        PadSample::paddingSamples, numFrames);
+
+    DBG("Resampled " << sample.getFreesoundId() << " from " << sample.getSampleRate() << " to "
+        << targetSampleRate << " Hz in " << (Time::getMillisecondCounterHiRes() - startTime) << " ms");
+
+    return new PadSample(sample.getFreesoundId(), std::move(audio), numFrames, numFrames,
+                         targetSampleRate, sample.getSourceFile(), storageToUse);
+}
+
+void DecodedSamplePool::timerCallback()
+{
+    const ScopedLock sl(lock);
+
+    StringArray unused;
+
+    for (HashMap<String, PadSample::Ptr>::Iterator i(samples); i.next();)
+        if (i.getValue()->getReferenceCount() == 1)
+            unused.add(i.getKey());
+
+    // Only the pool still refers to these: no kit, preview or waveform uses them
+    for (const auto& key : unused)
+        samples.remove(key);
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    DecodedSamplePool.h
+    Created: Process-wide cache of decoded pad audio, keyed by Freesound ID
+             (and sample rate, for copies resampled to the host rate)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "SampleKit.h"
+
+using namespace juce;
+
+//==============================================================================
+// Hold one in a SharedResourcePointer<DecodedSamplePool>: every kit, the
+// preview player and the pad waveforms of every plugin instance in the host
+// then share a single decoded copy of each sound.
+//
+// getSample() can be called from any thread except the audio thread. If two
+// threads ask for the same sound at once, one decodes and the other waits.
+// Entries nobody else references are dropped by a timer on the message thread.
+//
+// getSamples() fans a whole kit out over the pool's decode threads, which are
+// shared by every instance so ten plugins loading at once don't start ten
+// threads per core.
+//==============================================================================
+class DecodedSamplePool : private Timer
+{
+public:
+    DecodedSamplePool();
+    ~DecodedSamplePool() override;
+
+    // Only this much of each sound is decoded into memory, the rest is streamed
+    static constexpr double headLengthSeconds = 2.0;
+
+    // Returns the decoded sound, decoding audioFile on the calling thread if it
+    // isn't in the pool yet. Returns nullptr if the file can't be read.
+    //
+    // With a targetSampleRate, sounds that fit entirely in the head are
+    // resampled to that rate (and pooled separately from the native copy), so
+    // they play back without interpolation at their root note. Streamed sounds
+    // always come back at the file's own rate.
+    PadSample::Ptr getSample(const String& freesoundId, const File& audioFile,
+                             double targetSampleRate = 0.0);
+
+    struct SampleRequest
+    {
+        String freesoundId;
+        File audioFile;
+    };
+
+    // getSample() for several sounds at once. Each sound is its own decode job,
+    // and the calling thread works through them too until all are done.
+    // Results come back in request order. shouldStop is checked before each
+    // job; once it returns true the remaining ones are skipped (nullptr).
+    Array<PadSample::Ptr> getSamples(const Array<SampleRequest>& requests, double targetSampleRate = 0.0,
+                                     std::function<bool()> shouldStop = {});
+
+    // Threads one getSamples() call decodes on, the calling thread included
+    void setDecodeConcurrency(int numThreads);
+    int getDecodeConcurrency() const { return decodeConcurrency.load(); }
+
+    // Decodes the files from scratch, bypassing the pool, on numThreads threads
+    // and returns how long that took in seconds. For benchmarking kit loads.
+    double timeDecode(const Array<SampleRequest>& requests, int numThreads);
+
+    // Format of sounds decoded from now on. Process-wide, like the pool.
+    void setStorage(PadSample::Storage newStorage);
+    PadSample::Storage getStorage() const;
+
+    int getNumSamples() const;
+    size_t getMemoryUsage() const; // decoded audio held by the pool, in bytes
+
+private:
+    struct PendingDecode : public ReferenceCountedObject
+    {
+        WaitableEvent finished { true };
+    };
+
+    PadSample::Ptr getOrCreate(const String& key, const std::function<PadSample::Ptr()>& create);
+    PadSample::Ptr decode(const String& freesoundId, const File& audioFile, PadSample::Storage storageToUse);
+    static PadSample::Ptr resample(const PadSample& sample, double targetSampleRate, PadSample::Storage storageToUse);
+
+    // Calls job(0 ... numJobs - 1) on up to numThreads threads and returns once
+    // all of them have finished
+    void runInParallel(int numJobs, int numThreads, const std::function<void(int)>& job,
+                       const std::function<bool()>& shouldStop);
+
+    void timerCallback() override;
+
+    AudioFormatManager formatManager;
+    std::atomic<PadSample::Storage> storage { PadSample::Storage::Float32 };
+
+    ThreadPool decodeThreads;
+    std::atomic<int> decodeConcurrency;
+
+    CriticalSection lock;
+    HashMap<String, PadSample::Ptr> samples;
+    HashMap<String, ReferenceCountedObjectPtr<PendingDecode>> pendingDecodes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecodedSamplePool)
+};
@@ -0,0 +1,639 @@
+/*
+  ==============================================================================
+
+    DownloadScheduler.cpp
+    Created: Process-wide queue of sample downloads, shared by every part of
+             the plugin that fetches sounds from Freesound
+
+  ==============================================================================
+*/
+
+#include "DownloadScheduler.h"
+
+DownloadScheduler::DownloadScheduler()
+{
+}
+
+DownloadScheduler::~DownloadScheduler()
+{
+    stopTimer();
+
+    {
+        const ScopedLock sl(lock);
+
+        for (auto* worker : workers)
+            worker->signalThreadShouldExit();
+
+        for (auto& transfer : queue)
+            transfer->cancelled.store(true);
+    }
+
+    workAvailable.signal();
+    workers.clear();
+}
+
+File DownloadScheduler::getFileForSound(const String& freesoundId, const File& directory)
+{
+    return SampleStore::getSampleFile(directory, freesoundId);
+}
+
+File DownloadScheduler::getPartFile(const File& targetFile)
+{
+    return targetFile.getSiblingFile(targetFile.getFileName() + ".part");
+}
+
+void DownloadScheduler::setMaxConcurrentDownloads(int numWorkers)
+{
+    maxConcurrentDownloads.store(jlimit(1, 16, numWorkers));
+
+    const ScopedLock sl(lock);
+    startWorkersIfNeeded();
+}
+
+DownloadScheduler::RequestID DownloadScheduler::addRequest(const Array<FSSound>& sounds, const File& directory, Listener* listener,
+                                                          Priority priority)
+{
+    directory.createDirectory();
+    const bool inStore = directory == sampleStore->getFolder();
+
+    const ScopedLock sl(lock);
+
+    Request request;
+    request.id = nextRequestId++;
+    request.listener = listener;
+    request.priority = priority;
+
+    for (const auto& sound : sounds)
+    {
+        const File targetFile = getFileForSound(sound.id, directory);
+        const String key = targetFile.getFullPathName();
+
+        Transfer::Ptr transfer;
+
+        if (transfers.contains(key))
+        {
+            transfer = transfers[key];
+
+            // A failed transfer gets another go, and so does a finished one whose
+            // file has gone since (evicted, or deleted by hand). One that's still
+            // running (even if it was just cancelled) is picked up again instead
+            // of restarted.
+            const bool fileGone = transfer->state == TransferState::Succeeded
+                                  && !(inStore ? sampleStore->contains(sound.id) : targetFile.existsAsFile());
+
+            if (transfer->state == TransferState::Failed || fileGone)
+            {
+                transfer->state = TransferState::Queued;
+                transfer->downloaded.store(0);
+                transfer->total.store(0);
+                queue.add(transfer);
+
+                // Whoever wanted it last time may be gone: start again from the
+                // requests still waiting on it
+                updatePriority(*transfer);
+            }
+
+            transfer->cancelled.store(false);
+        }
+        else
+        {
+            transfer = new Transfer();
+            transfer->sound = sound;
+            transfer->targetFile = targetFile;
+            transfer->inStore = inStore;
+
+            if (inStore ? sampleStore->contains(sound.id) : targetFile.existsAsFile())
+            {
+                transfer->state = TransferState::Succeeded;
+                transfer->downloaded.store(targetFile.getSize());
+                transfer->total.store(targetFile.getSize());
+            }
+            else
+            {
+                queue.add(transfer);
+                updatePriority(*transfer); // it may be the hovered sound already
+            }
+
+            transfers.set(key, transfer);
+        }
+
+        transfer->waiters.addIfNotAlreadyThere(request.id);
+        transfer->priority = jmin(transfer->priority, priority);
+        request.transfers.add(transfer);
+        request.reportedFinished.add(false);
+    }
+
+    const auto id = request.id;
+    requests[id] = std::move(request);
+
+    startWorkersIfNeeded();
+    workAvailable.signal();
+    startTimer(100); // Update UI every 100ms
+
+    return id;
+}
+
+void DownloadScheduler::cancelRequest(RequestID requestId)
+{
+    const ScopedLock sl(lock);
+
+    auto it = requests.find(requestId);
+
+    if (it == requests.end())
+        return;
+
+    for (auto& transfer : it->second.transfers)
+    {
+        transfer->waiters.removeFirstMatchingValue(requestId);
+
+        if (!transfer->waiters.isEmpty())
+        {
+            updatePriority(*transfer);
+            continue;
+        }
+
+        // Nobody else wants it. A running one stops at its next read, keeps its
+        // .part file for whoever asks next and is dropped by finishTransfer().
+        // Any other is dropped now, so the next request looks at the disk again.
+        if (transfer->state == TransferState::Active)
+        {
+            transfer->cancelled.store(true);
+            continue;
+        }
+
+        if (transfer->state == TransferState::Queued)
+            queue.removeFirstMatchingValue(transfer);
+
+        removeTransfer(*transfer);
+    }
+
+    requests.erase(it);
+}
+
+bool DownloadScheduler::isRequestActive(RequestID requestId) const
+{
+    const ScopedLock sl(lock);
+    return requests.find(requestId) != requests.end();
+}
+
+void DownloadScheduler::setRequestPriority(RequestID requestId, Priority newPriority)
+{
+    const ScopedLock sl(lock);
+
+    auto it = requests.find(requestId);
+
+    if (it == requests.end())
+        return;
+
+    it->second.priority = newPriority;
+
+    for (auto& transfer : it->second.transfers)
+        updatePriority(*transfer);
+}
+
+void DownloadScheduler::boostSound(const String& freesoundId)
+{
+    const ScopedLock sl(lock);
+
+    for (auto& transfer : queue)
+    {
+        if (transfer->sound.id == freesoundId)
+        {
+            transfer->boosted = true;
+            transfer->priority = Priority::Interactive;
+        }
+    }
+}
+
+void DownloadScheduler::setHoveredSound(const String& freesoundId)
+{
+    const ScopedLock sl(lock);
+
+    if (freesoundId == hoveredSoundId)
+        return;
+
+    const auto previous = hoveredSoundId;
+    hoveredSoundId = freesoundId;
+
+    for (auto& transfer : queue)
+        if (transfer->sound.id == previous || transfer->sound.id == freesoundId)
+            updatePriority(*transfer);
+}
+
+void DownloadScheduler::updatePriority(Transfer& transfer)
+{
+    const bool hovered = hoveredSoundId.isNotEmpty() && transfer.sound.id == hoveredSoundId;
+    auto priority = (transfer.boosted || hovered) ? Priority::Interactive : Priority::Background;
+
+    for (auto waiter : transfer.waiters)
+    {
+        auto it = requests.find(waiter);
+
+        if (it != requests.end())
+            priority = jmin(priority, it->second.priority);
+    }
+
+    transfer.priority = priority;
+}
+
+void DownloadScheduler::startWorkersIfNeeded()
+{
+    // Most of each download is spent waiting on the server, so a few in parallel
+    // hide that latency much better than a faster single connection would
+    const int wanted = jmin(maxConcurrentDownloads.load(), workers.size() + queue.size());
+
+    while (workers.size() < wanted)
+        workers.add(new Worker(*this, workers.size()))->startThread();
+}
+
+DownloadScheduler::Transfer::Ptr DownloadScheduler::takeNextTransfer()
+{
+    const ScopedLock sl(lock);
+
+    if (queue.isEmpty())
+        return nullptr;
+
+    // The queue is in arrival order, so the first of the best priority is the
+    // one that has waited longest
+    int best = 0;
+
+    for (int i = 1; i < queue.size(); ++i)
+        if (queue.getUnchecked(i)->priority < queue.getUnchecked(best)->priority)
+            best = i;
+
+    auto transfer = queue.removeAndReturn(best);
+    transfer->state = TransferState::Active;
+    transfer->stoppedEarly.store(false);
+
+    // Pass the wake-up on to the next idle worker
+    if (!queue.isEmpty())
+        workAvailable.signal();
+
+    return transfer;
+}
+
+void DownloadScheduler::finishTransfer(Transfer& transfer, bool success)
+{
+    const ScopedLock sl(lock);
+
+    if (transfer.waiters.isEmpty())
+    {
+        // Cancelled by everyone who asked for it
+        transfer.state = TransferState::Failed;
+        removeTransfer(transfer);
+        return;
+    }
+
+    if (!success && transfer.stoppedEarly.load())
+    {
+        // Cancelled, then asked for again before the worker noticed: start over
+        transfer.cancelled.store(false);
+        transfer.state = TransferState::Queued;
+        queue.add(&transfer);
+        workAvailable.signal();
+        return;
+    }
+
+    transfer.state = success ? TransferState::Succeeded : TransferState::Failed;
+}
+
+void DownloadScheduler::removeTransfer(Transfer& transfer)
+{
+    // Caller holds the lock. Only if the map still points at this transfer, and
+    // not at a newer one for the same file.
+    const String key = transfer.targetFile.getFullPathName();
+
+    if (transfers.contains(key) && transfers[key].get() == &transfer)
+        transfers.remove(key);
+}
+
+DownloadScheduler::FileState DownloadScheduler::makeFileState(const Transfer& transfer)
+{
+    FileState state;
+    state.freesoundId = transfer.sound.id;
+    state.file = transfer.targetFile;
+    state.downloaded = transfer.downloaded.load();
+    state.total = transfer.total.load();
+    state.isActive = transfer.state == TransferState::Active;
+    state.isFinished = transfer.state == TransferState::Succeeded || transfer.state == TransferState::Failed;
+    state.failed = transfer.state == TransferState::Failed;
+    return state;
+}
+
+void DownloadScheduler::timerCallback()
+{
+    struct Update
+    {
+        RequestID id;
+        Listener* listener;
+        Array<FileState> files;
+        Array<int> newlyFinished;
+        bool allFinished;
+        bool success;
+    };
+
+    Array<Update> updates;
+
+    {
+        const ScopedLock sl(lock);
+
+        for (auto& [id, request] : requests)
+        {
+            // Coalesce: a tick where nothing moved sends nothing, which keeps a
+            // stalled download from repainting the UI ten times a second
+            int64 bytes = 0;
+            int numActive = 0;
+            bool hasUnreportedFinish = false;
+
+            for (int i = 0; i < request.transfers.size(); ++i)
+            {
+                const auto& transfer = *request.transfers.getUnchecked(i);
+                bytes += transfer.downloaded.load();
+
+                if (transfer.state == TransferState::Active)
+                    ++numActive;
+                else if (transfer.state != TransferState::Queued && !request.reportedFinished[i])
+                    hasUnreportedFinish = true;
+            }
+
+            if (!hasUnreportedFinish && bytes == request.lastReportedBytes && numActive == request.lastReportedActive)
+                continue;
+
+            request.lastReportedBytes = bytes;
+            request.lastReportedActive = numActive;
+
+            Update update { id, request.listener, {}, {}, true, true };
+
+            for (int i = 0; i < request.transfers.size(); ++i)
+            {
+                const auto state = makeFileState(*request.transfers.getUnchecked(i));
+
+                if (state.isFinished && !request.reportedFinished[i])
+                {
+                    request.reportedFinished.set(i, true);
+                    update.newlyFinished.add(i);
+                }
+
+                update.allFinished = update.allFinished && state.isFinished;
+                update.success = update.success && !state.failed;
+                update.files.add(state);
+            }
+
+            updates.add(std::move(update));
+        }
+    }
+
+    // Called without the lock, so listeners can add or cancel requests. A
+    // listener may cancel a request that comes later in this loop, hence the
+    // isRequestActive() checks.
+    for (const auto& update : updates)
+    {
+        if (update.listener == nullptr || !isRequestActive(update.id))
+            continue;
+
+        update.listener->downloadRequestProgress(update.id, update.files);
+
+        for (auto index : update.newlyFinished)
+            if (isRequestActive(update.id))
+                update.listener->downloadRequestFileFinished(update.id, update.files.getReference(index));
+
+        if (update.allFinished && isRequestActive(update.id))
+            update.listener->downloadRequestFinished(update.id, update.success);
+    }
+
+    const ScopedLock sl(lock);
+
+    // Finished requests let go of their transfers, so a failed file can be tried
+    // again by the next request and a finished one is found on disk
+    for (const auto& update : updates)
+    {
+        auto it = requests.find(update.id);
+
+        if (!update.allFinished || it == requests.end())
+            continue;
+
+        for (auto& transfer : it->second.transfers)
+        {
+            transfer->waiters.removeFirstMatchingValue(update.id);
+
+            if (transfer->waiters.isEmpty() && transfer->state != TransferState::Active)
+                removeTransfer(*transfer);
+        }
+
+        requests.erase(it);
+    }
+
+    if (requests.empty())
+        stopTimer();
+}
+
+//==============================================================================
+bool DownloadScheduler::downloadTransfer(Transfer& transfer, Thread& worker)
+{
+    URL url = transfer.sound.getOGGPreviewURL();
+
+    if (url.isEmpty())
+        return false;
+
+    // Data goes to FS_ID_XXXX.ogg.part and is only renamed once it's complete, so
+    // anything named FS_ID_XXXX.ogg can be trusted by the rest of the plugin
+    const File partFile = getPartFile(transfer.targetFile);
+    bool success = false;
+
+    if (!transfer.targetFile.getParentDirectory().createDirectory())
+        return false;
+
+    if (transfer.inStore)
+        sampleStore->markPartial(transfer.sound.id);
+
+    // A dropped connection keeps what it got, and the next attempt carries on from there
+    for (int attempt = 0; attempt < maxAttemptsPerFile && !success; ++attempt)
+    {
+        if (worker.threadShouldExit())
+            return false;
+
+        if (transfer.cancelled.load())
+        {
+            transfer.stoppedEarly.store(true);
+            return false;
+        }
+
+        if (attempt > 0)
+            Thread::sleep(250 * attempt);
+
+        success = fetchIntoPartFile(transfer, url, partFile, worker);
+    }
+
+    if (!success || !partFile.moveFileTo(transfer.targetFile))
+        return false;
+
+    if (transfer.inStore)
+        sampleStore->addCompletedFile(transfer.sound.id, transfer.targetFile);
+
+    return true;
+}
+
+bool DownloadScheduler::fetchIntoPartFile(Transfer& transfer, const URL& url, const File& partFile, Thread& worker)
+{
+    int64 resumeFrom = partFile.existsAsFile() ? partFile.getSize() : 0;
+
+    WebInputStream stream(url, false);
+
+    if (resumeFrom > 0)
+        stream.withExtraHeaders("Range: bytes=" + String(resumeFrom) + "-");
+
+    if (!stream.connect(nullptr))
+        return false;
+
+    const int statusCode = stream.getStatusCode();
+    int64 expectedSize = -1;
+
+    if (resumeFrom > 0 && statusCode == 206)
+    {
+        // "Content-Range: bytes <first>-<last>/<total>"
+        const auto contentRange = stream.getResponseHeaders().getValue("Content-Range", {});
+        const auto rangeStart = contentRange.fromFirstOccurrenceOf("bytes", false, true).trim().getLargeIntValue();
+
+        // Not the range we asked for, so start over on the next attempt
+        if (rangeStart != resumeFrom)
+        {
+            partFile.deleteFile();
+            return false;
+        }
+
+        const auto total = contentRange.fromLastOccurrenceOf("/", false, false).trim();
+        const int64 remaining = stream.getTotalLength();
+
+        if (total.containsOnly("0123456789") && total.isNotEmpty())
+            expectedSize = total.getLargeIntValue();
+        else if (remaining >= 0)
+            expectedSize = resumeFrom + remaining;
+    }
+    else if (statusCode == 200)
+    {
+        // Either a fresh download or a server that ignored the Range header
+        resumeFrom = 0;
+        expectedSize = stream.getTotalLength();
+    }
+    else
+    {
+        // 416 means the .part no longer matches what the server has (or is already
+        // longer than it), so throw it away rather than keep asking for it
+        if (statusCode == 416)
+            partFile.deleteFile();
+
+        return false;
+    }
+
+    transfer.downloaded.store(resumeFrom);
+    transfer.total.store(expectedSize > 0 ? expectedSize : 0);
+
+    auto shouldStop = [&]
+    {
+        if (transfer.cancelled.load())
+            transfer.stoppedEarly.store(true);
+
+        return worker.threadShouldExit() || transfer.stoppedEarly.load();
+    };
+
+    {
+        std::unique_ptr<FileOutputStream> output = partFile.createOutputStream();
+
+        if (output == nullptr || output->failedToOpen())
+            return false;
+
+        // createOutputStream() appends, which is what a resume wants; a full
+        // response has to replace whatever was there
+        if (resumeFrom == 0 && (!output->setPosition(0) || output->truncate().failed()))
+            return false;
+
+        // Reads start small and grow on a fast link, so each one takes roughly
+        // targetReadSeconds: few calls per megabyte there, while a slow link
+        // still reports progress and notices a cancel promptly
+        HeapBlock<char> buffer(maxReadSize);
+        int readSize = minReadSize;
+        int64 totalRead = resumeFrom;
+
+        while (!stream.isExhausted() && !shouldStop())
+        {
+            const auto readStart = Time::getMillisecondCounterHiRes();
+            int bytesRead = stream.read(buffer, readSize);
+            const auto readSeconds = (Time::getMillisecondCounterHiRes() - readStart) * 0.001;
+
+            if (bytesRead > 0)
+            {
+                if (!output->write(buffer, (size_t)bytesRead))
+                    return false;
+
+                totalRead += bytesRead;
+                transfer.downloaded.store(totalRead);
+
+                if (bytesRead == readSize && readSeconds < targetReadSeconds * 0.5)
+                    readSize = jmin(readSize * 2, maxReadSize);
+                else if (readSeconds > targetReadSeconds * 2.0)
+                    readSize = jmax(readSize / 2, minReadSize);
+            }
+            else
+            {
+                break; // End of stream or error; the length check below tells them apart
+            }
+        }
+
+        output->flush();
+
+        if (output->getStatus().failed())
+            return false;
+    }
+
+    if (shouldStop())
+        return false;
+
+    const int64 finalSize = partFile.getSize();
+
+    if (expectedSize < 0)
+        return finalSize > 0 && stream.isExhausted();
+
+    // More than the server said means the bytes can't be trusted; less means the
+    // connection dropped and the next attempt resumes from here
+    if (finalSize > expectedSize)
+        partFile.deleteFile();
+
+    return finalSize == expectedSize;
+}
+
+//==============================================================================
+DownloadScheduler::Worker::Worker(DownloadScheduler& ownerToUse, int indexToUse)
+    : Thread("AudioDownloader " + String(indexToUse + 1)),
+      owner(ownerToUse),
+      index(indexToUse)
+{
+}
+
+DownloadScheduler::Worker::~Worker()
+{
+    stopThread(4000);
+}
+
+void DownloadScheduler::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        // Left idle after setMaxConcurrentDownloads() lowered the limit
+        if (index >= owner.getMaxConcurrentDownloads())
+        {
+            wait(500);
+            continue;
+        }
+
+        auto transfer = owner.takeNextTransfer();
+
+        if (transfer == nullptr)
+        {
+            owner.workAvailable.wait(500);
+            continue;
+        }
+
+        const bool success = owner.downloadTransfer(*transfer, *this);
+        owner.finishTransfer(*transfer, success);
+    }
+}
@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    DownloadScheduler.h
+    Created: Process-wide queue of sample downloads, shared by every part of
+             the plugin that fetches sounds from Freesound
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "FreesoundAPI/FreesoundAPI.h"
+#include "SampleStore.h"
+
+using namespace juce;
+
+//==============================================================================
+// Hold one in a SharedResourcePointer<DownloadScheduler>. Callers add requests
+// (a list of sounds and the folder they go in) and get a RequestID back.
+//
+// Requests for a file that's already on its way share that transfer, so a
+// sound is only ever fetched once however many requests are waiting on it.
+// Cancelling a request only drops that request's interest: a transfer keeps
+// going as long as some other request still wants it, and unrelated requests
+// are never touched.
+//
+// Queued files are fetched by priority, then in the order they were asked
+// for. A file shared by several requests goes at the best of their priorities.
+//
+// addRequest() and cancelRequest() are meant for the message thread, and all
+// Listener callbacks arrive on it, from a timer. After cancelRequest() returns
+// the request's listener is never called again.
+//==============================================================================
+class DownloadScheduler : private Timer
+{
+public:
+    using RequestID = int;
+
+    // Lower comes first. Waiting on the user beats throughput.
+    enum class Priority
+    {
+        Interactive,    // a pad the user just clicked or is pointing at
+        Visible,        // pads showing in the grid
+        Background      // backfilling preset banks and bookmarks
+    };
+
+    struct FileState
+    {
+        String freesoundId;
+        File file;
+        int64 downloaded = 0;
+        int64 total = 0;        // 0 until the server reports a length
+        bool isActive = false;
+        bool isFinished = false;
+        bool failed = false;
+    };
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // One entry per sound, in the order they were passed to addRequest()
+        virtual void downloadRequestProgress(RequestID, const Array<FileState>&) {}
+        virtual void downloadRequestFileFinished(RequestID, const FileState&) {}
+        virtual void downloadRequestFinished(RequestID, bool success) = 0;
+    };
+
+    DownloadScheduler();
+    ~DownloadScheduler() override;
+
+    // Files that already exist in directory count as finished straight away. For
+    // the SampleStore's folder that's an index lookup, and finished downloads
+    // are added to the index.
+    RequestID addRequest(const Array<FSSound>& sounds, const File& directory, Listener* listener,
+                         Priority priority = Priority::Visible);
+    void cancelRequest(RequestID requestId);
+    bool isRequestActive(RequestID requestId) const;
+
+    // These only affect files that are still queued
+    void setRequestPriority(RequestID requestId, Priority newPriority);
+    void boostSound(const String& freesoundId); // moves it up to Interactive for good
+
+    // Interactive only while it stays the hovered sound; an empty id clears it
+    void setHoveredSound(const String& freesoundId);
+
+    // Number of files fetched at once
+    void setMaxConcurrentDownloads(int numWorkers);
+    int getMaxConcurrentDownloads() const { return maxConcurrentDownloads.load(); }
+
+    static File getFileForSound(const String& freesoundId, const File& directory);
+
+    // Where an unfinished download of targetFile is kept until it can be renamed
+    static File getPartFile(const File& targetFile);
+
+private:
+    enum class TransferState { Queued, Active, Succeeded, Failed };
+
+    // One file on its way, shared by every request waiting on it
+    struct Transfer : public ReferenceCountedObject
+    {
+        using Ptr = ReferenceCountedObjectPtr<Transfer>;
+
+        FSSound sound;
+        File targetFile;
+        bool inStore = false;
+        TransferState state = TransferState::Queued;    // guarded by the scheduler's lock
+        Array<RequestID> waiters;                       // guarded by the scheduler's lock
+        Priority priority = Priority::Background;       // guarded by the scheduler's lock
+        bool boosted = false;                           // guarded by the scheduler's lock
+
+        std::atomic<int64> downloaded { 0 };
+        std::atomic<int64> total { 0 };
+        std::atomic<bool> cancelled { false };          // nobody is waiting any more
+        std::atomic<bool> stoppedEarly { false };       // the worker gave up because of a cancel
+    };
+
+    struct Request
+    {
+        RequestID id = 0;
+        Listener* listener = nullptr;
+        Priority priority = Priority::Visible;
+        Array<Transfer::Ptr> transfers;
+        Array<bool> reportedFinished;
+        int64 lastReportedBytes = -1;
+        int lastReportedActive = -1;
+    };
+
+    class Worker : public Thread
+    {
+    public:
+        Worker(DownloadScheduler& owner, int index);
+        ~Worker() override;
+        void run() override;
+
+    private:
+        DownloadScheduler& owner;
+        const int index;
+    };
+
+    Transfer::Ptr takeNextTransfer();
+    void finishTransfer(Transfer& transfer, bool success);
+    void removeTransfer(Transfer& transfer);
+    void startWorkersIfNeeded();
+    void updatePriority(Transfer& transfer);
+
+    bool downloadTransfer(Transfer& transfer, Thread& worker);
+    bool fetchIntoPartFile(Transfer& transfer, const URL& url, const File& partFile, Thread& worker);
+
+    void timerCallback() override;
+    static FileState makeFileState(const Transfer& transfer);
+
+    static constexpr int maxAttemptsPerFile = 3;
+    static constexpr int minReadSize = 64 * 1024;
+    static constexpr int maxReadSize = 1024 * 1024;
+    static constexpr double targetReadSeconds = 0.1;
+
+    mutable CriticalSection lock;
+    HashMap<String, Transfer::Ptr> transfers;   // keyed by target file path
+    Array<Transfer::Ptr> queue;
+    std::map<RequestID, Request> requests;
+    RequestID nextRequestId = 1;
+    String hoveredSoundId;
+
+    SharedResourcePointer<SampleStore> sampleStore;
+
+    OwnedArray<Worker> workers;
+    WaitableEvent workAvailable;
+    std::atomic<int> maxConcurrentDownloads { 4 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DownloadScheduler)
+};
@@ -3,11 +3,15 @@
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
 #include "FreesoundAPI/FreesoundAPI.h"
 #include "FreesoundKeys.h"
-#include <random>
 
 using namespace juce;
 
-inline std::pair<Array<FSSound>, std::vector<juce::StringArray>> makeQuerySearchUsingFreesoundAPI (const String& masterQuery, int numSoundsNeeded, bool shuffleResults = true) {
+using QuerySearchResult = std::pair<Array<FSSound>, std::vector<juce::StringArray>>;
+
+// Picks numSoundsNeeded sounds for the query. Shuffled, they're drawn at random
+// from all the results, fetching only the few pages they come from; the same
+// non-zero seed gives the same sounds again. Unshuffled, they're the best scored.
+inline QuerySearchResult makeQuerySearchUsingFreesoundAPI (const String& masterQuery, int numSoundsNeeded, bool shuffleResults = true, int64 seed = 0) {
 
   // Use the existing Freesound search system
     FreesoundClient client(FREESOUND_API_KEY);
@@ -17,50 +21,39 @@ inline std::pair<Array<FSSound>, std::vector<juce::StringArray>> makeQuerySearch
 
     try
     {
-        // Request more results than we need to have variety for shuffling
-        // Use page_size parameter (5th parameter) to get multiple results
-        int requestedResults = jmax(numSoundsNeeded * 2, 50); // Request at least 50 or 2x what we need
-
-        SoundList list = client.textSearch(
-            masterQuery,
-            "duration:[0 TO 0.5]",
-            "score",
-            1,
-            1,
-            10000,
-            "id,name,username,license,previews,tags,description"
-        );
-
-        Array<FSSound> sounds = list.toArrayOfSounds();
+        const String filter = "duration:[0 TO 0.5]";
+        const String fields = "id,name,username,license,previews,tags,description";
+
+        if (seed == 0)
+            seed = Random::getSystemRandom().nextInt64();
+
+        // Candidates are kept as a table, and only the ones picked are turned
+        // into FSSounds
+        FSSoundTable candidates = shuffleResults
+            ? client.textSearchSample(masterQuery, numSoundsNeeded, seed, filter, "score", 1, fields)
+            : client.textSearchAsTable(masterQuery, filter, "score", 1, 1, jlimit(1, FreesoundClient::maxPageSize, numSoundsNeeded), fields);
 
         // 1. Handle no results case
-        if (sounds.isEmpty())
+        if (candidates.isEmpty())
         {
             DBG("No results found for query: " + masterQuery);
             return { finalSounds, soundInfo };
         }
 
-        // 3. Shuffle results if more than one sound found
-        if (shuffleResults && sounds.size() > 1)
-        {
-            std::random_device rd;
-            std::mt19937 g(rd());
-            std::shuffle(sounds.begin(), sounds.end(), g);
-        }
-
-        // 4. downsample or repeat in a cycling manner to fill the required number
+        // 2. repeat in a cycling manner to fill the required number when the
+        // query has fewer results
         for (int i = 0; i < numSoundsNeeded; ++i)
         {
-            int sourceIndex = i % sounds.size(); // Cycle through available sounds
-            finalSounds.add(sounds[sourceIndex]);
+            const auto row = candidates[i % candidates.size()]; // Cycle through available sounds
+            finalSounds.add(row.toSound());
 
             // Create sound info for each repeated sound
             StringArray info;
-            info.add(sounds[sourceIndex].name);                             // index 0
-            info.add(sounds[sourceIndex].user);                             // index 1
-            info.add(sounds[sourceIndex].license);                          // index 2
-            info.add(sounds[sourceIndex].tags.joinIntoString(","));      // index 3
-            info.add(sounds[sourceIndex].description);                      // index 4
+            info.add(row.getName());                                    // index 0
+            info.add(row.getUser());                                    // index 1
+            info.add(row.getLicense());                                 // index 2
+            info.add(row.getTags().joinIntoString(","));                // index 3
+            info.add(row.getDescription());                             // index 4
             info.add(masterQuery); // Store the master query             // index 5
 
             soundInfo.push_back(info);
@@ -79,4 +72,30 @@ inline std::pair<Array<FSSound>, std::vector<juce::StringArray>> makeQuerySearch
 
 }
 
+// Same search on the Freesound request pool, so the message thread never waits
+// on the network. Get the result with .then(), which is called on the message
+// thread, and cancel() the future to drop a search nobody wants any more.
+inline FSFuture<QuerySearchResult> makeQuerySearchUsingFreesoundAPIAsync (const String& masterQuery, int numSoundsNeeded, bool shuffleResults = true, int64 seed = 0) {
+
+    FreesoundClient client(FREESOUND_API_KEY);
+
+    return client.runAsync<QuerySearchResult>([=](FreesoundClient&) {
+        return makeQuerySearchUsingFreesoundAPI(masterQuery, numSoundsNeeded, shuffleResults, seed);
+    });
+}
+
+
 
+// Downloads the largest page the API serves for the query and reports how long
+// it takes to decode, and how much heap, through a var tree and streamed.
+// Blocks, so call it from a background thread.
+inline String benchmarkQuerySearchDecoding (const String& masterQuery) {
+
+    FreesoundClient client(FREESOUND_API_KEY);
+
+    const String report = client.benchmarkSoundListDecoding(masterQuery, "duration:[0 TO 0.5]",
+                                                            "id,name,username,license,previews,tags,description",
+                                                            FreesoundClient::maxPageSize);
+    DBG(report);
+    return report;
+}
@@ -527,6 +527,26 @@ void MasterSearchPanel::downloadCompleted(bool success)
         }
 
         // Hide progress components after a delay
+        Timer::callAfterDelay(2000, [this]()
+        {
+            showProgress(false);
+        });
+    });
+}
+
+void MasterSearchPanel::backfillCompleted(bool success)
+{
+    MessageManager::callAsync([this, success]()
+    {
+        cancelButton.setEnabled(false);
+
+        statusLabel.setText(success ? "Missing samples downloaded" :
+                          "Some samples could not be downloaded",
+                          dontSendNotification);
+
+        currentProgress = success ? 1.0 : 0.0;
+        progressBar.repaint();
+
         Timer::callAfterDelay(2000, [this]()
         {
             showProgress(false);
@@ -94,6 +94,7 @@ public:
     void showProgress(bool show);
     void updateDownloadProgress(const AudioDownloadManager::DownloadProgress& progress);
     void downloadCompleted(bool success);
+    void backfillCompleted(bool success); // same display, but no pads are filled
 
     std::function<void(const String&)> onMasterQueryChanged;
     std::function<void()> onSearchSelectedClicked;
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    PadEventQueue.h
+    Created: Lock-free queue carrying pad and preview triggers from the UI
+             to the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+//==============================================================================
+// A single trigger sent from the editor (pads, keyboard, bookmark previews)
+//==============================================================================
+struct PadEvent
+{
+    enum class Type : uint8
+    {
+        NoteOn,
+        NoteOff,
+        PreviewStart,
+        PreviewStop
+    };
+
+    Type type = Type::NoteOn;
+    int noteNumber = 0;
+    uint8 velocity = 0;
+    double timestampMs = 0.0; // Time::getMillisecondCounterHiRes() at push time
+};
+
+//==============================================================================
+// Preallocated single-producer / single-consumer ring of PadEvents.
+// push() must only be called from the message thread and drain() only from
+// the audio thread. Neither side locks or allocates.
+//==============================================================================
+class PadEventQueue
+{
+public:
+    static constexpr int capacity = 256;
+
+    PadEventQueue() : fifo(capacity) {}
+
+    // Returns false if the ring is full and the event had to be dropped
+    bool push(const PadEvent& event)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return false;
+
+        events[(size_t)(size1 > 0 ? start1 : start2)] = event;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    // Calls handler(const PadEvent&) for every queued event, in push order
+    template <typename Handler>
+    void drain(Handler&& handler)
+    {
+        const int numReady = fifo.getNumReady();
+
+        if (numReady == 0)
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            handler(events[(size_t)(start1 + i)]);
+
+        for (int i = 0; i < size2; ++i)
+            handler(events[(size_t)(start2 + i)]);
+
+        fifo.finishedRead(size1 + size2);
+    }
+
+private:
+    AbstractFifo fifo;
+    std::array<PadEvent, capacity> events;
+
+    JUCE_DECLARE_NON_COPYABLE(PadEventQueue)
+};
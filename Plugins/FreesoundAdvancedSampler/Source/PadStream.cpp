@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    PadStream.cpp
+    Created: Background read-ahead for pads that are longer than their
+             preloaded head
+
+  ==============================================================================
+*/
+
+#include "PadStream.h"
+
+PadStream::PadStream()
+{
+    readAheadThread->addTimeSliceClient(this);
+}
+
+PadStream::~PadStream()
+{
+    readAheadThread->removeTimeSliceClient(this);
+
+    // Release references still sitting in unhandled start commands
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        if (auto* kit = commands[(size_t)(start1 + i)].kit)
+            kit->decReferenceCount();
+
+    for (int i = 0; i < size2; ++i)
+        if (auto* kit = commands[(size_t)(start2 + i)].kit)
+            kit->decReferenceCount();
+
+    commandFifo.finishedRead(size1 + size2);
+}
+
+void PadStream::start(SampleKit* kit, int padIndex)
+{
+    jassert(kit != nullptr);
+
+    Command command;
+    command.type = Command::Type::Start;
+    command.kit = kit;
+    command.padIndex = padIndex;
+    command.generation = ++requestedGeneration;
+
+    // Never the last reference: SampleKitExchange keeps every kit alive until
+    // nothing else refers to it
+    kit->incReferenceCount();
+    pushCommand(command);
+}
+
+void PadStream::stop()
+{
+    Command command;
+    command.type = Command::Type::Stop;
+    command.generation = ++requestedGeneration;
+    pushCommand(command);
+}
+
+void PadStream::pushCommand(const Command& command)
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        // Only possible if the read-ahead thread is stalled; the voice will
+        // underrun, which it handles
+        if (command.kit != nullptr)
+            command.kit->decReferenceCount();
+        return;
+    }
+
+    commands[(size_t)(size1 > 0 ? start1 : start2)] = command;
+    commandFifo.finishedWrite(1);
+}
+
+int PadStream::read(float* left, float* right, int numFrames)
+{
+    if (activeGeneration.load(std::memory_order_acquire) != requestedGeneration)
+    {
+        numUnderruns.fetch_add(1);
+        return 0;
+    }
+
+    // Skip whatever an earlier note left in the ring
+    const int64 leftover = generationStartFrame.load(std::memory_order_acquire) - framesRead;
+
+    if (leftover > 0)
+    {
+        const int toSkip = (int)jmin(leftover, (int64)ringFifo.getNumReady());
+        ringFifo.finishedRead(toSkip);
+        framesRead += toSkip;
+
+        if (toSkip < leftover)
+        {
+            numUnderruns.fetch_add(1);
+            return 0;
+        }
+    }
+
+    int start1, size1, start2, size2;
+    ringFifo.prepareToRead(numFrames, start1, size1, start2, size2);
+
+    if (size1 > 0)
+    {
+        FloatVectorOperations::copy(left, ring.getReadPointer(0, start1), size1);
+        FloatVectorOperations::copy(right, ring.getReadPointer(1, start1), size1);
+    }
+
+    if (size2 > 0)
+    {
+        FloatVectorOperations::copy(left + size1, ring.getReadPointer(0, start2), size2);
+        FloatVectorOperations::copy(right + size1, ring.getReadPointer(1, start2), size2);
+    }
+
+    const int numRead = size1 + size2;
+    ringFifo.finishedRead(numRead);
+    framesRead += numRead;
+
+    if (numRead < numFrames)
+        numUnderruns.fetch_add(1);
+
+    return numRead;
+}
+
+int PadStream::useTimeSlice()
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        handleCommand(commands[(size_t)(start1 + i)]);
+
+    for (int i = 0; i < size2; ++i)
+        handleCommand(commands[(size_t)(start2 + i)]);
+
+    commandFifo.finishedRead(size1 + size2);
+
+    if (reader == nullptr)
+        return 10;
+
+    fillRing();
+
+    // Come straight back while there is room to fill, otherwise let the voice drain
+    const bool finished = readPosition >= streamingSample->getLengthInSamples();
+    return (finished || ringFifo.getFreeSpace() < readChunkSize) ? 5 : 0;
+}
+
+void PadStream::handleCommand(const Command& command)
+{
+    reader.reset();
+    streamingSample = nullptr;
+    streamingKit = nullptr;
+
+    if (command.type == Command::Type::Start)
+    {
+        // Adopt the reference taken in start()
+        streamingKit = command.kit;
+        command.kit->decReferenceCount();
+
+        streamingSample = streamingKit->getPad(command.padIndex);
+
+        if (streamingSample != nullptr && streamingSample->isStreamed())
+            reader.reset(readAheadThread->createReaderFor(streamingSample->getSourceFile()));
+
+        if (reader != nullptr)
+            readPosition = streamingSample->getHeadLength();
+    }
+
+    // Everything written from now on belongs to this generation
+    generationStartFrame.store(framesWritten.load(), std::memory_order_release);
+    activeGeneration.store(command.generation, std::memory_order_release);
+}
+
+void PadStream::fillRing()
+{
+    const int64 remaining = streamingSample->getLengthInSamples() - readPosition;
+    const int numToRead = (int)jmin((int64)readChunkSize, (int64)ringFifo.getFreeSpace(), remaining);
+
+    if (numToRead <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    ringFifo.prepareToWrite(numToRead, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        reader->read(&ring, start1, size1, readPosition, true, true);
+
+    if (size2 > 0)
+        reader->read(&ring, start2, size2, readPosition + size1, true, true);
+
+    readPosition += size1 + size2;
+    ringFifo.finishedWrite(size1 + size2);
+    framesWritten.fetch_add(size1 + size2, std::memory_order_release);
+}
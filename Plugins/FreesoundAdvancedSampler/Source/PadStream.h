@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    PadStream.h
+    Created: Background read-ahead for pads that are longer than their
+             preloaded head
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "SampleKit.h"
+
+using namespace juce;
+
+//==============================================================================
+// One disk reading thread shared by every PadStream in the process
+//==============================================================================
+class PadReadAheadThread : public TimeSliceThread
+{
+public:
+    PadReadAheadThread() : TimeSliceThread("Pad read-ahead")
+    {
+        formatManager.registerBasicFormats();
+        startThread();
+    }
+
+    ~PadReadAheadThread() override
+    {
+        stopThread(4000);
+    }
+
+    // Read-ahead thread only
+    AudioFormatReader* createReaderFor(const File& file) { return formatManager.createReaderFor(file); }
+
+private:
+    AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PadReadAheadThread)
+};
+
+//==============================================================================
+// Streams the part of a PadSample that follows its preloaded head, for one
+// voice. The voice calls start()/stop()/read() on the audio thread; the file is
+// opened and read on the shared read-ahead thread into a lock-free ring.
+//
+// Every start() gets a new generation number. The read-ahead thread records at
+// which ring frame a generation begins, so read() can skip anything still left
+// over from a previous note without the two threads ever resetting the ring.
+//==============================================================================
+class PadStream : private TimeSliceClient
+{
+public:
+    static constexpr int ringSize = 16384;     // frames buffered ahead per voice
+    static constexpr int readChunkSize = 4096; // frames read from disk at a time
+
+    PadStream();
+    ~PadStream() override;
+
+    // Audio thread only. The kit must stay referenced by the caller until
+    // start() returns; the stream takes its own reference.
+    void start(SampleKit* kit, int padIndex);
+    void stop();
+
+    // Audio thread only: copies up to numFrames stereo frames, returns how many
+    // were available (fewer means the disk could not keep up)
+    int read(float* left, float* right, int numFrames);
+
+    // Number of times read() came up short since construction
+    int getNumUnderruns() const { return numUnderruns.load(); }
+
+private:
+    struct Command
+    {
+        enum class Type { Start, Stop };
+
+        Type type = Type::Stop;
+        SampleKit* kit = nullptr; // carries one reference, adopted by the read-ahead thread
+        int padIndex = -1;
+        uint32 generation = 0;
+    };
+
+    int useTimeSlice() override;
+    void pushCommand(const Command& command);
+    void handleCommand(const Command& command);
+    void fillRing();
+
+    SharedResourcePointer<PadReadAheadThread> readAheadThread;
+
+    // Audio -> read-ahead thread
+    AbstractFifo commandFifo { 16 };
+    std::array<Command, 16> commands;
+
+    // Read-ahead thread -> audio
+    AbstractFifo ringFifo { ringSize };
+    AudioBuffer<float> ring { 2, ringSize };
+    std::atomic<int64> framesWritten { 0 };
+    std::atomic<int64> generationStartFrame { 0 };
+    std::atomic<uint32> activeGeneration { 0 };
+
+    // Audio thread only
+    uint32 requestedGeneration = 0;
+    int64 framesRead = 0;
+    std::atomic<int> numUnderruns { 0 };
+
+    // Read-ahead thread only
+    SampleKit::Ptr streamingKit;
+    PadSample* streamingSample = nullptr;
+    std::unique_ptr<AudioFormatReader> reader;
+    int64 readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PadStream)
+};
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    PadSynthesiser.cpp
+    Created: Synthesiser with a fixed voice pool, a polyphony limit, an
+             explicit voice stealing policy and O(1) note-off lookup
+
+  ==============================================================================
+*/
+
+#include "PadSynthesiser.h"
+
+void PadSynthesiser::allocateVoices(const std::function<SynthesiserVoice*()>& createVoice)
+{
+    if (getNumVoices() > 0)
+        return;
+
+    for (int i = 0; i < maxVoices; ++i)
+        addVoice(createVoice());
+}
+
+SynthesiserVoice*& PadSynthesiser::heldVoiceSlot(int midiChannel, int midiNoteNumber)
+{
+    return heldVoices[(size_t)(((midiChannel - 1) & 15) * 128 + (midiNoteNumber & 127))];
+}
+
+SynthesiserVoice* PadSynthesiser::findHeldVoice(int midiChannel, int midiNoteNumber)
+{
+    auto* voice = heldVoiceSlot(midiChannel, midiNoteNumber);
+
+    if (voice != nullptr
+        && voice->getCurrentlyPlayingNote() == midiNoteNumber
+        && voice->isPlayingChannel(midiChannel))
+        return voice;
+
+    return nullptr;
+}
+
+void PadSynthesiser::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    const ScopedLock sl(lock);
+
+    for (auto* sound : sounds)
+    {
+        if (sound->appliesToNote(midiNoteNumber) && sound->appliesToChannel(midiChannel))
+        {
+            // Hitting a pad that is still held releases the previous hit first
+            if (auto* previous = findHeldVoice(midiChannel, midiNoteNumber))
+            {
+                previous->setKeyDown(false);
+                stopVoice(previous, 1.0f, true);
+            }
+
+            auto* voice = findFreeVoice(sound, midiChannel, midiNoteNumber, isNoteStealingEnabled());
+            startVoice(voice, sound, midiChannel, midiNoteNumber, velocity);
+
+            heldVoiceSlot(midiChannel, midiNoteNumber) = voice;
+        }
+    }
+}
+
+void PadSynthesiser::noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
+    const ScopedLock sl(lock);
+
+    // Pads don't follow the sustain pedal, so the held voice can be released directly
+    if (auto* voice = findHeldVoice(midiChannel, midiNoteNumber))
+    {
+        voice->setKeyDown(false);
+        stopVoice(voice, velocity, allowTailOff);
+    }
+
+    heldVoiceSlot(midiChannel, midiNoteNumber) = nullptr;
+}
+
+SynthesiserVoice* PadSynthesiser::findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel,
+                                                int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    const ScopedLock sl(lock);
+
+    const int numUsable = getNumUsableVoices();
+
+    for (int i = 0; i < numUsable; ++i)
+    {
+        auto* voice = voices.getUnchecked(i);
+
+        if (!voice->isVoiceActive() && voice->canPlaySound(soundToPlay))
+            return voice;
+    }
+
+    if (stealIfNoneAvailable)
+        return findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber);
+
+    return nullptr;
+}
+
+SynthesiserVoice* PadSynthesiser::findVoiceToSteal(SynthesiserSound* soundToPlay, int,
+                                                   int midiNoteNumber) const
+{
+    const auto policy = voiceStealing.load();
+
+    if (policy == VoiceStealing::None)
+        return nullptr;
+
+    const int numUsable = getNumUsableVoices();
+    SynthesiserVoice* oldest = nullptr;
+
+    for (int i = 0; i < numUsable; ++i)
+    {
+        auto* voice = voices.getUnchecked(i);
+
+        if (!voice->canPlaySound(soundToPlay))
+            continue;
+
+        if (policy == VoiceStealing::SameNoteFirst && voice->getCurrentlyPlayingNote() == midiNoteNumber)
+            return voice;
+
+        if (oldest == nullptr || voice->wasStartedBefore(*oldest))
+            oldest = voice;
+    }
+
+    return oldest;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    PadSynthesiser.h
+    Created: Synthesiser with a fixed voice pool, a polyphony limit, an
+             explicit voice stealing policy and O(1) note-off lookup
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+class PadSynthesiser : public Synthesiser
+{
+public:
+    // Upper bound for the pool; the polyphony limit can be set anywhere below it
+    static constexpr int maxVoices = 32;
+
+    enum class VoiceStealing
+    {
+        SameNoteFirst, // Reuse the voice still ringing on the same pad, else the oldest
+        Oldest,        // Always take the voice that was started first
+        None           // Drop the new note when all voices are busy
+    };
+
+    PadSynthesiser() = default;
+
+    // Fills the voice pool. Only does anything the first time it is called, so
+    // the voices (and their memory) live for as long as the synthesiser does.
+    void allocateVoices(const std::function<SynthesiserVoice*()>& createVoice);
+
+    void setPolyphonyLimit(int numVoices) { polyphonyLimit.store(jlimit(1, maxVoices, numVoices)); }
+    int getPolyphonyLimit() const { return polyphonyLimit.load(); }
+
+    void setVoiceStealing(VoiceStealing policy) { voiceStealing.store(policy); }
+    VoiceStealing getVoiceStealing() const { return voiceStealing.load(); }
+
+    //==============================================================================
+    void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+    void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+
+protected:
+    SynthesiserVoice* findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel,
+                                    int midiNoteNumber, bool stealIfNoneAvailable) const override;
+    SynthesiserVoice* findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel,
+                                       int midiNoteNumber) const override;
+
+private:
+    int getNumUsableVoices() const { return jmin(voices.size(), polyphonyLimit.load()); }
+    SynthesiserVoice*& heldVoiceSlot(int midiChannel, int midiNoteNumber);
+    SynthesiserVoice* findHeldVoice(int midiChannel, int midiNoteNumber);
+
+    std::atomic<int> polyphonyLimit { 16 };
+    std::atomic<VoiceStealing> voiceStealing { VoiceStealing::SameNoteFirst };
+
+    // Voice whose key is currently held for every channel/note, audio thread only.
+    // Entries can go stale when a voice ends by itself, so they are always
+    // checked against the voice before use.
+    std::array<SynthesiserVoice*, 16 * 128> heldVoices {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PadSynthesiser)
+};
@@ -0,0 +1,346 @@
+/*
+  ==============================================================================
+
+    PadVoiceKernel.cpp
+    Created: Block-based interpolation kernels for the pad voices, vectorised
+             with SSE or NEON where JUCE enables them
+
+  ==============================================================================
+*/
+
+#include "PadVoiceKernel.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    // Four floats, in whichever registers the target has
+   #if JUCE_USE_SSE_INTRINSICS
+    using Vec = __m128;
+
+    inline Vec load(const float* p)                         { return _mm_loadu_ps(p); }
+    inline void store(float* p, Vec v)                      { _mm_storeu_ps(p, v); }
+    inline Vec set(float a, float b, float c, float d)      { return _mm_setr_ps(a, b, c, d); }
+    inline Vec dup(float a)                                 { return _mm_set1_ps(a); }
+    inline Vec add(Vec a, Vec b)                            { return _mm_add_ps(a, b); }
+    inline Vec sub(Vec a, Vec b)                            { return _mm_sub_ps(a, b); }
+    inline Vec mul(Vec a, Vec b)                            { return _mm_mul_ps(a, b); }
+
+    inline float sum(Vec v)
+    {
+        const Vec pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+   #elif JUCE_USE_ARM_NEON
+    using Vec = float32x4_t;
+
+    inline Vec load(const float* p)                         { return vld1q_f32(p); }
+    inline void store(float* p, Vec v)                      { vst1q_f32(p, v); }
+    inline Vec dup(float a)                                 { return vdupq_n_f32(a); }
+    inline Vec add(Vec a, Vec b)                            { return vaddq_f32(a, b); }
+    inline Vec sub(Vec a, Vec b)                            { return vsubq_f32(a, b); }
+    inline Vec mul(Vec a, Vec b)                            { return vmulq_f32(a, b); }
+
+    inline Vec set(float a, float b, float c, float d)
+    {
+        const float values[4] = { a, b, c, d };
+        return vld1q_f32(values);
+    }
+
+    inline float sum(Vec v)
+    {
+        const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+    }
+   #else
+    struct Vec { float v[4]; };
+
+    inline Vec load(const float* p)                         { return { { p[0], p[1], p[2], p[3] } }; }
+    inline void store(float* p, Vec a)                      { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+    inline Vec set(float a, float b, float c, float d)      { return { { a, b, c, d } }; }
+    inline Vec dup(float a)                                 { return { { a, a, a, a } }; }
+    inline Vec add(Vec a, Vec b)                            { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    inline Vec sub(Vec a, Vec b)                            { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+    inline Vec mul(Vec a, Vec b)                            { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+    inline float sum(Vec a)                                 { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+   #endif
+
+    //==============================================================================
+    // Integer frame and fraction for four consecutive output frames
+    struct Positions
+    {
+        int index[4];
+        float alpha[4];
+    };
+
+    inline void getPositions(double position, double increment, int first, Positions& p)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            const double pos = position + increment * (first + k);
+            p.index[k] = (int)pos;
+            p.alpha[k] = (float)(pos - (double)p.index[k]);
+        }
+    }
+
+    inline Vec gather(const float* src, const Positions& p, int offset)
+    {
+        return set(src[p.index[0] + offset], src[p.index[1] + offset],
+                   src[p.index[2] + offset], src[p.index[3] + offset]);
+    }
+
+    //==============================================================================
+    void interpolateLinear(const float* src, double position, double increment, float* dest, int numSamples)
+    {
+        int i = 0;
+        Positions p;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            getPositions(position, increment, i, p);
+
+            const Vec a = gather(src, p, 0);
+            const Vec b = gather(src, p, 1);
+            store(dest + i, add(a, mul(load(p.alpha), sub(b, a))));
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            const double pos = position + increment * i;
+            const int index = (int)pos;
+            const float alpha = (float)(pos - (double)index);
+            dest[i] = src[index] + alpha * (src[index + 1] - src[index]);
+        }
+    }
+
+    //==============================================================================
+    void interpolateHermite(const float* src, double position, double increment, float* dest, int numSamples)
+    {
+        const Vec half = dup(0.5f), oneAndHalf = dup(1.5f), two = dup(2.0f), twoAndHalf = dup(2.5f);
+
+        int i = 0;
+        Positions p;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            getPositions(position, increment, i, p);
+
+            const Vec xm1 = gather(src, p, -1);
+            const Vec x0 = gather(src, p, 0);
+            const Vec x1 = gather(src, p, 1);
+            const Vec x2 = gather(src, p, 2);
+            const Vec t = load(p.alpha);
+
+            const Vec c1 = mul(half, sub(x1, xm1));
+            const Vec c2 = sub(add(xm1, mul(two, x1)), add(mul(twoAndHalf, x0), mul(half, x2)));
+            const Vec c3 = add(mul(half, sub(x2, xm1)), mul(oneAndHalf, sub(x0, x1)));
+
+            store(dest + i, add(mul(add(mul(add(mul(c3, t), c2), t), c1), t), x0));
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            const double pos = position + increment * i;
+            const int index = (int)pos;
+            const float t = (float)(pos - (double)index);
+
+            const float xm1 = src[index - 1], x0 = src[index], x1 = src[index + 1], x2 = src[index + 2];
+            const float c1 = 0.5f * (x1 - xm1);
+            const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+            const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+
+            dest[i] = ((c3 * t + c2) * t + c1) * t + x0;
+        }
+    }
+
+    //==============================================================================
+    // Blackman-windowed sinc, one row of 8 taps per fractional phase. Each row is
+    // normalised to unity gain so DC passes unchanged whatever the phase.
+    struct SincTable
+    {
+        static constexpr int numTaps = 8;
+        static constexpr int numPhases = 512;
+
+        SincTable()
+        {
+            constexpr double pi = MathConstants<double>::pi;
+            constexpr double halfWidth = numTaps / 2;
+
+            for (int phase = 0; phase <= numPhases; ++phase)
+            {
+                const double alpha = (double)phase / numPhases;
+                double total = 0.0;
+
+                for (int tap = 0; tap < numTaps; ++tap)
+                {
+                    const double x = (tap - PadVoiceKernel::tapsBefore) - alpha;
+                    const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+                    const double w = x / halfWidth;
+                    const double window = std::abs(w) < 1.0 ? 0.42 + 0.5 * std::cos(pi * w) + 0.08 * std::cos(2.0 * pi * w)
+                                                            : 0.0;
+                    rows[phase][tap] = (float)(sinc * window);
+                    total += rows[phase][tap];
+                }
+
+                for (int tap = 0; tap < numTaps; ++tap)
+                    rows[phase][tap] = (float)(rows[phase][tap] / total);
+            }
+        }
+
+        const float* getRow(float alpha) const  { return rows[(int)(alpha * numPhases + 0.5f)]; }
+
+        alignas(16) float rows[numPhases + 1][numTaps];
+    };
+
+    // Built when the plugin is loaded, so the audio thread never pays for it or
+    // for the guard a function-local static would need
+    const SincTable sincTable;
+
+    void interpolateSinc8(const float* src, double position, double increment, float* dest, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double pos = position + increment * i;
+            const int index = (int)pos;
+            const float* row = sincTable.getRow((float)(pos - (double)index));
+            const float* taps = src + index - PadVoiceKernel::tapsBefore;
+
+            dest[i] = sum(add(mul(load(taps), load(row)),
+                              mul(load(taps + 4), load(row + 4))));
+        }
+    }
+}
+
+void PadVoiceKernel::interpolate(Interpolation interpolation, const float* src,
+                                 double position, double increment,
+                                 float* dest, int numSamples)
+{
+    jassert(position >= (double)tapsBefore);
+
+    switch (interpolation)
+    {
+        case Interpolation::CubicHermite:   interpolateHermite(src, position, increment, dest, numSamples); break;
+        case Interpolation::Sinc8:          interpolateSinc8(src, position, increment, dest, numSamples); break;
+        case Interpolation::Linear:
+        default:                            interpolateLinear(src, position, increment, dest, numSamples); break;
+    }
+}
+
+//==============================================================================
+namespace
+{
+    constexpr float int16Scale = 1.0f / 32768.0f;
+
+    inline float decodeHalf(uint16 h)
+    {
+        // Shift exponent and mantissa into place, then rescale the exponent bias
+        // with a multiply, which also takes care of subnormals
+        const uint32 bits = (uint32)(h & 0x7fff) << 13;
+        float magnitude;
+        std::memcpy(&magnitude, &bits, sizeof(float));
+        magnitude *= 5.192296858534828e33f; // 2^112
+
+        return (h & 0x8000) != 0 ? -magnitude : magnitude;
+    }
+
+    inline uint16 encodeHalf(float value)
+    {
+        const float magnitude = jmin(std::abs(value), 65504.0f);
+        const uint16 sign = value < 0.0f ? 0x8000 : 0;
+
+        // Subnormal range, steps of 2^-24
+        if (magnitude < 6.103515625e-05f)
+            return (uint16)(sign | (uint16)roundToInt(magnitude * 16777216.0f));
+
+        uint32 bits;
+        std::memcpy(&bits, &magnitude, sizeof(float));
+
+        // Rebias the exponent and round the mantissa to 10 bits, to nearest even
+        const uint32 rounded = bits + 0x0fff + ((bits >> 13) & 1);
+        return (uint16)(sign | (uint16)((rounded >> 13) - ((127 - 15) << 10)));
+    }
+}
+
+void PadVoiceKernel::int16ToFloat(const int16* src, float* dest, int numSamples)
+{
+    int i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const __m128 scale = _mm_set1_ps(int16Scale);
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+        // Sign-extend by placing each value in the top half and shifting down
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+   #elif JUCE_USE_ARM_NEON
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const int16x8_t x = vld1q_s16(src + i);
+
+        vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), int16Scale));
+        vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), int16Scale));
+    }
+   #endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = (float)src[i] * int16Scale;
+}
+
+void PadVoiceKernel::halfToFloat(const uint16* src, float* dest, int numSamples)
+{
+    int i = 0;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const __m128i magnitudeMask = _mm_set1_epi32(0x7fff);
+    const __m128i signMask = _mm_set1_epi32(0x8000);
+    const __m128 rebias = _mm_set1_ps(5.192296858534828e33f);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const __m128i x = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)), zero);
+        const __m128i magnitude = _mm_slli_epi32(_mm_and_si128(x, magnitudeMask), 13);
+        const __m128i sign = _mm_slli_epi32(_mm_and_si128(x, signMask), 16);
+
+        const __m128 value = _mm_mul_ps(_mm_castsi128_ps(magnitude), rebias);
+        _mm_storeu_ps(dest + i, _mm_or_ps(value, _mm_castsi128_ps(sign)));
+    }
+   #elif JUCE_USE_ARM_NEON
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const uint32x4_t x = vmovl_u16(vld1_u16(src + i));
+        const uint32x4_t magnitude = vshlq_n_u32(vandq_u32(x, vdupq_n_u32(0x7fff)), 13);
+        const uint32x4_t sign = vshlq_n_u32(vandq_u32(x, vdupq_n_u32(0x8000)), 16);
+
+        const float32x4_t value = vmulq_n_f32(vreinterpretq_f32_u32(magnitude), 5.192296858534828e33f);
+        vst1q_f32(dest + i, vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(value), sign)));
+    }
+   #endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = decodeHalf(src[i]);
+}
+
+void PadVoiceKernel::floatToInt16(const float* src, int16* dest, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = (int16)jlimit(-32768, 32767, roundToInt(src[i] * 32768.0f));
+}
+
+void PadVoiceKernel::floatToHalf(const float* src, uint16* dest, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = encodeHalf(src[i]);
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    PadVoiceKernel.h
+    Created: Block-based interpolation kernels for the pad voices, vectorised
+             with SSE or NEON where JUCE enables them
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+//==============================================================================
+// Reads one channel of a contiguous source at a fixed increment. The voices
+// gather the frames they need (head and streamed tail) into a staging buffer
+// first, so the kernels never have to care where the audio came from.
+//
+// Four output frames are computed per step; the taps have to be gathered one
+// by one, but the weights and the sums run in vector registers. Envelopes are
+// applied afterwards with FloatVectorOperations.
+//
+// Also holds the conversions for pads stored as int16 or half floats.
+//==============================================================================
+class PadVoiceKernel
+{
+public:
+    enum class Interpolation
+    {
+        Linear,         // 2 taps, the old behaviour
+        CubicHermite,   // 4 taps
+        Sinc8           // 8-tap windowed sinc
+    };
+
+    // Source frames read around each position, for every interpolation type
+    static constexpr int tapsBefore = 3;
+    static constexpr int tapsAfter = 4;
+
+    // Writes numSamples frames read at position, position + increment, ...
+    // src must be readable from floor(position) - tapsBefore up to
+    // floor(position + increment * (numSamples - 1)) + tapsAfter.
+    static void interpolate(Interpolation interpolation, const float* src,
+                            double position, double increment,
+                            float* dest, int numSamples);
+
+    // Compact sample storage (see PadSample::Storage). Decoding runs on the
+    // audio thread while rendering; encoding happens once, when a sound loads.
+    static void int16ToFloat(const int16* src, float* dest, int numSamples);
+    static void halfToFloat(const uint16* src, float* dest, int numSamples);
+    static void floatToInt16(const float* src, int16* dest, int numSamples);
+    static void floatToHalf(const float* src, uint16* dest, int numSamples);
+
+private:
+    PadVoiceKernel() = delete;
+};
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    PlaybackState.h
+    Created: Wait-free pad and preview playback state, written by the audio
+             thread and polled by the editor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "SampleKit.h"
+
+using namespace juce;
+
+//==============================================================================
+// One slot per grid pad plus one for the preview player. The audio thread only
+// ever stores into these atomics; the editor reads them once per frame, so
+// nothing on the audio thread depends on how often (or whether) the UI looks.
+//
+// Fields are independent atomics: a reader may see a position from one block
+// and a play state from the next, which is harmless for display.
+//==============================================================================
+class PlaybackStateBoard
+{
+public:
+    static constexpr int previewSlot = SampleKit::numPads;
+    static constexpr int numSlots = SampleKit::numPads + 1;
+
+    struct SlotState
+    {
+        bool isPlaying = false;
+        float position = 0.0f;      // 0..1 through the sample, whatever rate it is stored at
+        uint32 startCount = 0;      // bumps on every start, so hits shorter than a frame still show
+        int64 freesoundId = 0;      // sound that was started last, 0 if unknown
+    };
+
+    PlaybackStateBoard() = default;
+
+    //==============================================================================
+    // Audio thread
+    void noteStarted(int slot, int64 freesoundId)
+    {
+        if (!isPositiveAndBelow(slot, numSlots))
+            return;
+
+        auto& s = slots[(size_t)slot];
+        s.freesoundId.store(freesoundId, std::memory_order_relaxed);
+        s.position.store(0.0f, std::memory_order_relaxed);
+        s.startCount.fetch_add(1, std::memory_order_relaxed);
+        s.isPlaying.store(true, std::memory_order_release);
+    }
+
+    void noteStopped(int slot)
+    {
+        if (isPositiveAndBelow(slot, numSlots))
+            slots[(size_t)slot].isPlaying.store(false, std::memory_order_release);
+    }
+
+    void setPosition(int slot, float position)
+    {
+        if (isPositiveAndBelow(slot, numSlots))
+            slots[(size_t)slot].position.store(position, std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    // Any thread
+    SlotState getState(int slot) const
+    {
+        SlotState state;
+
+        if (isPositiveAndBelow(slot, numSlots))
+        {
+            const auto& s = slots[(size_t)slot];
+            state.isPlaying = s.isPlaying.load(std::memory_order_acquire);
+            state.position = s.position.load(std::memory_order_relaxed);
+            state.startCount = s.startCount.load(std::memory_order_relaxed);
+            state.freesoundId = s.freesoundId.load(std::memory_order_relaxed);
+        }
+
+        return state;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> isPlaying { false };
+        std::atomic<float> position { 0.0f };
+        std::atomic<uint32> startCount { 0 };
+        std::atomic<int64> freesoundId { 0 };
+    };
+
+    std::array<Slot, numSlots> slots;
+
+    JUCE_DECLARE_NON_COPYABLE(PlaybackStateBoard)
+};
@@ -127,13 +127,24 @@ FreesoundAdvancedSamplerAudioProcessorEditor::FreesoundAdvancedSamplerAudioProce
     }
 });
 
+    // Pad and preview playheads are polled at roughly the display refresh rate
+    startTimerHz(60);
 }
 
 FreesoundAdvancedSamplerAudioProcessorEditor::~FreesoundAdvancedSamplerAudioProcessorEditor()
 {
+    stopTimer();
     LookAndFeel::setDefaultLookAndFeel(nullptr);
     processor.removeDownloadListener(this);
 }
+
+void FreesoundAdvancedSamplerAudioProcessorEditor::timerCallback()
+{
+    const auto& playbackState = processor.getPlaybackState();
+
+    sampleGridComponent.updatePlaybackState(playbackState);
+    bookmarkViewerComponent.updatePlaybackState(playbackState);
+}
 //==============================================================================
 void FreesoundAdvancedSamplerAudioProcessorEditor::paint(Graphics& g)
 {
@@ -283,6 +294,11 @@ void FreesoundAdvancedSamplerAudioProcessorEditor::downloadCompleted(bool succes
     sampleGridComponent.getMasterSearchPanel().downloadCompleted(success);
 }
 
+void FreesoundAdvancedSamplerAudioProcessorEditor::backfillCompleted(bool success)
+{
+    sampleGridComponent.getMasterSearchPanel().backfillCompleted(success);
+}
+
 void FreesoundAdvancedSamplerAudioProcessorEditor::handlePresetLoadRequested(const PresetInfo& presetInfo, int slotIndex)
 {
     // First, check sample availability before loading
@@ -305,8 +321,7 @@ void FreesoundAdvancedSamplerAudioProcessorEditor::handlePresetLoadRequested(con
     {
         allUniqueSampleIds.addIfNotAlreadyThere(padInfo.freesoundId);
 
-        File sampleFile = processor.getPresetManager().getSampleFile(padInfo.freesoundId);
-        if (!sampleFile.existsAsFile())
+        if (!processor.getPresetManager().sampleExists(padInfo.freesoundId))
         {
             missingSampleIds.addIfNotAlreadyThere(padInfo.freesoundId);
         }
@@ -23,7 +23,8 @@
 /**
 */
 class FreesoundAdvancedSamplerAudioProcessorEditor  : public AudioProcessorEditor,
-                                                  public FreesoundAdvancedSamplerAudioProcessor::DownloadListener
+                                                  public FreesoundAdvancedSamplerAudioProcessor::DownloadListener,
+                                                  private Timer
 {
 public:
     FreesoundAdvancedSamplerAudioProcessorEditor (FreesoundAdvancedSamplerAudioProcessor&);
@@ -36,6 +37,7 @@ public:
     // Download listener methods
     void downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress) override;
     void downloadCompleted(bool success) override;
+    void backfillCompleted(bool success) override;
 
     bool saveCurrentAsPreset(const String& name, const String& description = "", int slotIndex = 0);
     bool loadPreset(const File& presetFile, int slotIndex = 0);
@@ -77,5 +79,9 @@ private:
     void updateSizeConstraintsForCurrentPanelStates();
 
     int getKeyboardPadIndex(const KeyPress& key) const;
+
+    // Polls the processor's playback state once per display frame
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FreesoundAdvancedSamplerAudioProcessorEditor)
 };
\ No newline at end of file
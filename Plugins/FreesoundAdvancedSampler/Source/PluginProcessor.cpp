@@ -20,121 +20,344 @@ FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::TrackingSamplerVoi
 {
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::startNote(int midiNoteNumber, float velocity, SynthesiserSound* sound, int currentPitchWheelPosition)
+bool FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::canPlaySound(SynthesiserSound* sound)
 {
-    SamplerVoice::startNote(midiNoteNumber, velocity, sound, currentPitchWheelPosition);
+    return dynamic_cast<const KitSound*>(sound) != nullptr;
+}
 
-    currentNoteNumber = midiNoteNumber;
-    samplePosition = 0.0;
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::startNote(int midiNoteNumber, float velocity, SynthesiserSound*, int)
+{
+    const int padIndex = getPadIndexForNote(midiNoteNumber);
+    auto* kit = getCurrentKit();
+    auto* sample = kit != nullptr ? kit->getPad(padIndex) : nullptr;
 
-    // Get sample length from the sound
-    if (auto* samplerSound = dynamic_cast<SamplerSound*>(sound))
+    // Empty pad: nothing to play
+    if (sample == nullptr || sample->getLengthInSamples() <= 0)
     {
-        sampleLength = samplerSound->getAudioData()->getNumSamples();
+        clearCurrentNote();
+        return;
     }
 
-    processor.notifyNoteStarted(midiNoteNumber, velocity);
+    playingKit = kit;
+    playingSample = sample;
+    pitchRatio = sample->getSampleRate() / getSampleRate();
+    gain = velocity;
+    interpolation = processor.voiceInterpolation.load();
+
+    samplePosition = 0.0;
+    sampleLength = (double)sample->getLengthInSamples();
+
+    // Long samples: start reading past the head now, it covers the disk latency
+    windowStart = sample->getHeadLength();
+    windowFilled = 0;
+
+    if (sample->isStreamed())
+        stream.start(kit, padIndex);
+
+    // For sustained playback (samples play until note off or their end),
+    // with a short 100ms fade after note off
+    adsr.setSampleRate(getSampleRate());
+    adsr.setParameters({ 0.0f, 0.0f, 1.0f, 0.1f });
+    adsr.reset();
+    adsr.noteOn();
+
+    stateSlot = getStateSlotForNote(midiNoteNumber);
+    processor.playbackState.noteStarted(stateSlot, sample->getNumericId());
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::stopNote(float velocity, bool allowTailOff)
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::stopNote(float, bool allowTailOff)
 {
-    if (currentNoteNumber >= 0)
+    if (allowTailOff)
     {
-        processor.notifyNoteStopped(currentNoteNumber);
-        currentNoteNumber = -1;
+        // The pad shows as stopped once released, the tail just fades out
+        adsr.noteOff();
+        reportStopped();
+    }
+    else
+    {
+        finishNote();
     }
-
-    SamplerVoice::stopNote(velocity, allowTailOff);
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::reportStopped()
 {
-    SamplerVoice::renderNextBlock(outputBuffer, startSample, numSamples);
-
-    // Update playhead position
-    if (currentNoteNumber >= 0 && sampleLength > 0)
+    if (stateSlot >= 0)
     {
-        samplePosition += numSamples;
-        float position = (float)samplePosition / (float)sampleLength;
-        processor.notifyPlayheadPositionChanged(currentNoteNumber, jlimit(0.0f, 1.0f, position));
+        processor.playbackState.noteStopped(stateSlot);
+        stateSlot = -1;
     }
 }
 
-//==============================================================================
-// TrackingPreviewSamplerVoice Implementation (Add after TrackingSamplerVoice)
-//==============================================================================
-
-FreesoundAdvancedSamplerAudioProcessor::TrackingPreviewSamplerVoice::TrackingPreviewSamplerVoice(FreesoundAdvancedSamplerAudioProcessor& owner)
-    : processor(owner)
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::finishNote()
 {
+    reportStopped();
+
+    adsr.reset();
+    clearCurrentNote();
+
+    if (playingSample != nullptr && playingSample->isStreamed())
+        stream.stop();
+
+    // Old kits are only ever freed by SampleKitExchange on the message thread
+    playingSample = nullptr;
+    playingKit = nullptr;
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingPreviewSamplerVoice::startNote(int midiNoteNumber, float velocity, SynthesiserSound* sound, int currentPitchWheelPosition)
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::fillStreamWindow(int64 firstFrame, int64 lastFrame)
 {
+    firstFrame = jmax(firstFrame, (int64)playingSample->getHeadLength());
+
+    for (;;)
+    {
+        // Drop frames the playhead has already passed
+        const int numToDrop = (int)jmin((int64)windowFilled, firstFrame - windowStart);
+
+        if (numToDrop > 0)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                auto* data = streamWindow.getWritePointer(channel);
+                std::memmove(data, data + numToDrop, sizeof(float) * (size_t)(windowFilled - numToDrop));
+            }
+
+            windowStart += numToDrop;
+            windowFilled -= numToDrop;
+        }
+
+        const int numWanted = (int)jmin((int64)(streamWindowSize - windowFilled),
+                                        lastFrame + 1 - (windowStart + windowFilled));
+
+        if (numWanted <= 0)
+            return;
+
+        const int numRead = stream.read(streamWindow.getWritePointer(0, windowFilled),
+                                        streamWindow.getWritePointer(1, windowFilled),
+                                        numWanted);
+        windowFilled += numRead;
 
-    // Call parent first
-    SamplerVoice::startNote(midiNoteNumber, velocity, sound, currentPitchWheelPosition);
+        // Only loop again when catching up after an underrun
+        if (numRead < numWanted || windowStart + windowFilled > firstFrame)
+            return;
+    }
+}
 
-    // Extract freesound ID from the sound name
-    if (auto* samplerSound = dynamic_cast<SamplerSound*>(sound))
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::gatherFrames(int64 firstFrame, int numFrames, int numChannels)
+{
+    const int64 headLength = playingSample->getHeadLength();
+    const bool isStreamed = playingSample->isStreamed();
+
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        String soundName = samplerSound->getName();
+        float* dest = staging.getWritePointer(channel);
+        const int headChannel = jmin(channel, playingSample->getNumChannels() - 1);
+        int64 frame = firstFrame;
+        int done = 0;
 
-        if (soundName.startsWith("preview_"))
+        // Before the start of the sample
+        if (frame < 0)
         {
-            currentFreesoundId = soundName.substring(8); // Remove "preview_" prefix
-            samplePosition = 0.0;
-            sampleLength = samplerSound->getAudioData()->getNumSamples();
+            const int num = (int)jmin((int64)numFrames, -frame);
+            FloatVectorOperations::clear(dest, num);
+            done += num;
+            frame += num;
+        }
 
-            // Notify that preview started
-            processor.notifyPreviewStarted(currentFreesoundId);
+        if (done < numFrames && frame < headLength)
+        {
+            const int num = (int)jmin((int64)(numFrames - done), headLength - frame);
+            playingSample->readFrames(headChannel, (int)frame, dest + done, num); // converts compact storage
+            done += num;
+            frame += num;
         }
-        else
+
+        if (isStreamed && done < numFrames && frame < windowStart + windowFilled)
         {
-            DBG("  - Sound name doesn't start with 'preview_', ignoring");
+            // Frames the window has already dropped (after an underrun) stay silent
+            if (frame < windowStart)
+            {
+                const int num = (int)jmin((int64)(numFrames - done), windowStart - frame);
+                FloatVectorOperations::clear(dest + done, num);
+                done += num;
+                frame += num;
+            }
+
+            const int num = (int)jmin((int64)(numFrames - done), windowStart + windowFilled - frame);
+
+            if (num > 0)
+            {
+                FloatVectorOperations::copy(dest + done, streamWindow.getReadPointer(channel, (int)(frame - windowStart)), num);
+                done += num;
+            }
         }
+
+        // Past the end, or not streamed in yet
+        if (done < numFrames)
+            FloatVectorOperations::clear(dest + done, numFrames - done);
+    }
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::fillEnvelope(int numSamples)
+{
+    // ADSR is stateful so this stays scalar, applying it is vectorised
+    float* env = envelope.getWritePointer(0);
+
+    for (int i = 0; i < numSamples; ++i)
+        env[i] = adsr.getNextSample() * gain;
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::addToOutput(const float* left, const float* right,
+                                                                               float* outL, float* outR, int numSamples)
+{
+    float* env = envelope.getWritePointer(0);
+
+    if (outR != nullptr)
+    {
+        FloatVectorOperations::addWithMultiply(outL, left, env, numSamples);
+        FloatVectorOperations::addWithMultiply(outR, right, env, numSamples);
     }
     else
     {
-        DBG("  - Not a SamplerSound, ignoring");
+        FloatVectorOperations::multiply(env, 0.5f, numSamples);
+        FloatVectorOperations::addWithMultiply(outL, left, env, numSamples);
+        FloatVectorOperations::addWithMultiply(outL, right, env, numSamples);
+    }
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    if (playingSample == nullptr)
+        return;
+
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    float* outL = outputBuffer.getWritePointer(0, startSample);
+    float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+    // Pads resampled to our rate on load need no interpolation at their root note
+    const int numRendered = (pitchRatio == 1.0 && !playingSample->isStreamed())
+                              ? renderAtRootRate(outL, outR, numSamples)
+                              : renderInterpolated(outL, outR, numSamples);
+
+    processor.addVoiceRenderTime(Time::getHighResolutionTicks() - startTicks, numRendered);
+
+    // Update playhead position, as a fraction of the sample. Pads may be stored
+    // at the file's rate or resampled to ours, so no rate correction applies.
+    if (playingSample != nullptr && stateSlot >= 0 && sampleLength > 0)
+    {
+        float position = (float)(samplePosition / sampleLength);
+        processor.playbackState.setPosition(stateSlot, jlimit(0.0f, 1.0f, position));
     }
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingPreviewSamplerVoice::stopNote(float velocity, bool allowTailOff)
+int FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::renderInterpolated(float* outL, float* outR, int numSamples)
 {
-    if (currentFreesoundId.isNotEmpty())
+    const bool isStreamed = playingSample->isStreamed();
+    const int numChannels = playingSample->getNumChannels() > 1 ? 2 : 1;
+
+    // Chunks whose source frames, taps included, all fit in the stream window
+    const int maxSpan = streamWindowSize - PadVoiceKernel::tapsBefore - PadVoiceKernel::tapsAfter - 2;
+    const int maxChunk = jlimit(1, renderChunkSize, (int)(maxSpan / pitchRatio) - 1);
+
+    int numDone = 0;
+
+    while (numDone < numSamples)
     {
-        processor.notifyPreviewStopped(currentFreesoundId);
-        currentFreesoundId = "";
-        samplePosition = 0.0;
-        sampleLength = 0.0;
+        // Never render past the last source frame
+        const int numToEnd = (int)std::ceil((sampleLength - samplePosition) / pitchRatio);
+        const int numThisChunk = jmin(numSamples - numDone, maxChunk, jmax(1, numToEnd));
+
+        const int64 firstFrame = (int64)samplePosition - PadVoiceKernel::tapsBefore;
+        const int64 lastFrame = (int64)(samplePosition + pitchRatio * (numThisChunk - 1)) + PadVoiceKernel::tapsAfter;
+
+        if (isStreamed && lastFrame >= playingSample->getHeadLength())
+            fillStreamWindow(firstFrame, jmin(lastFrame, playingSample->getLengthInSamples() - 1));
+
+        gatherFrames(firstFrame, (int)(lastFrame - firstFrame) + 1, numChannels);
+
+        const double position = samplePosition - (double)firstFrame;
+        float* left = rendered.getWritePointer(0);
+        float* right = left;
+
+        PadVoiceKernel::interpolate(interpolation, staging.getReadPointer(0), position, pitchRatio, left, numThisChunk);
+
+        if (numChannels > 1)
+        {
+            right = rendered.getWritePointer(1);
+            PadVoiceKernel::interpolate(interpolation, staging.getReadPointer(1), position, pitchRatio, right, numThisChunk);
+        }
+
+        fillEnvelope(numThisChunk);
+        addToOutput(left, right, outL + numDone, outR != nullptr ? outR + numDone : nullptr, numThisChunk);
+
+        numDone += numThisChunk;
+        samplePosition += pitchRatio * numThisChunk;
+
+        if (samplePosition >= sampleLength || !adsr.isActive())
+        {
+            finishNote();
+            break;
+        }
     }
 
-    SamplerVoice::stopNote(velocity, allowTailOff);
+    return numDone;
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::TrackingPreviewSamplerVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+int FreesoundAdvancedSamplerAudioProcessor::TrackingSamplerVoice::renderAtRootRate(float* outL, float* outR, int numSamples)
 {
-    // Call parent first to actually render the audio
-    SamplerVoice::renderNextBlock(outputBuffer, startSample, numSamples);
+    const bool isStereo = playingSample->getNumChannels() > 1;
 
-    // Update playhead position for preview
-    if (currentFreesoundId.isNotEmpty() && sampleLength > 0 && isVoiceActive())
+    int numDone = 0;
+
+    while (numDone < numSamples)
     {
-        samplePosition += numSamples;
-        float position = (float)samplePosition / (float)sampleLength;
+        const int start = (int)samplePosition;
+        const int numThisChunk = jmin(numSamples - numDone, renderChunkSize, playingSample->getHeadLength() - start);
+
+        const float* left = playingSample->getFloatData(0);
+        const float* right = isStereo ? playingSample->getFloatData(1) : left;
+
+        if (left != nullptr)
+        {
+            left += start;
+            right += start;
+        }
+        else
+        {
+            // Compact storage: convert just this chunk
+            playingSample->readFrames(0, start, rendered.getWritePointer(0), numThisChunk);
+            left = right = rendered.getReadPointer(0);
+
+            if (isStereo)
+            {
+                playingSample->readFrames(1, start, rendered.getWritePointer(1), numThisChunk);
+                right = rendered.getReadPointer(1);
+            }
+        }
+
+        fillEnvelope(numThisChunk);
+        addToOutput(left, right, outL + numDone, outR != nullptr ? outR + numDone : nullptr, numThisChunk);
 
-        // Always send position updates for smooth animation
-        processor.notifyPreviewPlayheadPositionChanged(currentFreesoundId, jlimit(0.0f, 1.0f, position));
+        numDone += numThisChunk;
+        samplePosition += numThisChunk;
 
-        // Always send the final position when near the end
-        if (position >= 0.99f)
+        if (samplePosition >= sampleLength || !adsr.isActive())
         {
-            processor.notifyPreviewPlayheadPositionChanged(currentFreesoundId, 1.0f);
+            finishNote();
+            break;
         }
     }
+
+    return numDone;
 }
 
+//==============================================================================
+// TrackingPreviewSamplerVoice Implementation (Add after TrackingSamplerVoice)
+//==============================================================================
+
+FreesoundAdvancedSamplerAudioProcessor::TrackingPreviewSamplerVoice::TrackingPreviewSamplerVoice(FreesoundAdvancedSamplerAudioProcessor& owner)
+    : TrackingSamplerVoice(owner)
+{
+}
 
 //==============================================================================
 // FreesoundAdvancedSamplerAudioProcessor Implementation
@@ -156,25 +379,31 @@ FreesoundAdvancedSamplerAudioProcessor::FreesoundAdvancedSamplerAudioProcessor()
     tmpDownloadLocation = File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("FreesoundAdvancedSampler");
     tmpDownloadLocation.createDirectory();
     currentSessionDownloadLocation = presetManager.getSamplesFolder();
-    midicounter = 1;
-    startTime = Time::getMillisecondCounterHiRes() * 0.001;
-
-    // Initialize preview sampler format manager
-    if (previewAudioFormatManager.getNumKnownFormats() == 0) {
-        previewAudioFormatManager.registerBasicFormats();
-    }
 
     // FIXED: Add tracking voice for preview sampler (not regular voice)
     previewSampler.addVoice(new TrackingPreviewSamplerVoice(*this));
+    previewSampler.addSound(new KitSound(previewNote, 1));
+
+    // The main sampler is set up once; new sample sets arrive as SampleKits
+    sampler.addSound(new KitSound());
 
     // Add download manager listener
     downloadManager.addListener(this);
+
+    // Backfill waits behind anything the grid asks for
+    backfillDownloadManager.setPriority(DownloadScheduler::Priority::Background);
+    backfillDownloadManager.addListener(&backfillForwarder);
+
+    presetManager.getSampleStore().addPinProvider(this, [this](StringArray& ids) { return getPinnedSampleIds(ids); });
 }
 
 FreesoundAdvancedSamplerAudioProcessor::~FreesoundAdvancedSamplerAudioProcessor()
 {
 	// Remove download manager listener
 	downloadManager.removeListener(this);
+	backfillDownloadManager.removeListener(&backfillForwarder);
+
+	presetManager.getSampleStore().removePinProvider(this);
 
 	// Note: We no longer delete the tmp directory to preserve downloaded files
 
@@ -269,13 +498,15 @@ bool FreesoundAdvancedSamplerAudioProcessor::isBusesLayoutSupported (const Buses
 
 void FreesoundAdvancedSamplerAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
-    // Add MIDI events from editor
-    midiMessages.addEvents(midiFromEditor, 0, INT_MAX, 0);
-    midiFromEditor.clear();
+    // Pick up freshly built kits, if any were published since the last block
+    audioThreadKit = kitExchange.acquireForAudioThread();
+    audioThreadPreviewKit = previewKitExchange.acquireForAudioThread();
 
-    // Create separate MIDI buffers for main and preview samplers
-    MidiBuffer mainMidiBuffer;
-    MidiBuffer previewMidiBuffer;
+    const int numSamples = buffer.getNumSamples();
+
+    // Reuse the preallocated MIDI buffers (clear() keeps their storage)
+    mainMidiBuffer.clear();
+    previewMidiBuffer.clear();
 
     // Split MIDI messages by channel
     for (const auto metadata : midiMessages)
@@ -292,21 +523,39 @@ void FreesoundAdvancedSamplerAudioProcessor::processBlock(AudioBuffer<float>& bu
         }
     }
 
+    // Add pad/preview triggers coming from the editor
+    drainUiEvents(numSamples);
+
     // Render main sampler
-    sampler.renderNextBlock(buffer, mainMidiBuffer, 0, buffer.getNumSamples());
+    sampler.renderNextBlock(buffer, mainMidiBuffer, 0, numSamples);
 
     // Render preview sampler on top (mix with main output)
-    if (previewSampler.getNumSounds() > 0)
+    if (audioThreadPreviewKit != nullptr)
     {
-        AudioBuffer<float> previewBuffer(buffer.getNumChannels(), buffer.getNumSamples());
-        previewBuffer.clear();
+        // Only reallocates if the host breaks its promised maximum block size
+        if (previewBuffer.getNumChannels() < buffer.getNumChannels() || previewBuffer.getNumSamples() < numSamples)
+            previewBuffer.setSize(buffer.getNumChannels(), numSamples, false, false, true);
+
+        previewBuffer.clear(0, numSamples);
+        previewSampler.renderNextBlock(previewBuffer, previewMidiBuffer, 0, numSamples);
 
-        previewSampler.renderNextBlock(previewBuffer, previewMidiBuffer, 0, buffer.getNumSamples());
+        // Mix preview with main output using a smoothed gain
+        previewGain.setTargetValue(previewGainTarget.load());
 
-        // Mix preview with main output at reduced volume
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        if (previewGain.isSmoothing())
         {
-            buffer.addFrom(channel, 0, previewBuffer, channel, 0, buffer.getNumSamples(), 0.6f); // 60% volume for preview
+            const float startGain = previewGain.getCurrentValue();
+            const float endGain = previewGain.skip(numSamples);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.addFromWithRamp(channel, 0, previewBuffer.getReadPointer(channel), numSamples, startGain, endGain);
+        }
+        else
+        {
+            const float gain = previewGain.getTargetValue();
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                FloatVectorOperations::addWithMultiply(buffer.getWritePointer(channel), previewBuffer.getReadPointer(channel), gain, numSamples);
         }
     }
 
@@ -316,8 +565,77 @@ void FreesoundAdvancedSamplerAudioProcessor::processBlock(AudioBuffer<float>& bu
 // Modify prepareToPlay to prepare both samplers
 void FreesoundAdvancedSamplerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    // Voices are created on the first call only and reused across kit reloads
+    sampler.allocateVoices([this] { return new TrackingSamplerVoice(*this); });
+
     sampler.setCurrentPlaybackSampleRate(sampleRate);
     previewSampler.setCurrentPlaybackSampleRate(sampleRate);
+
+    // Re-resamples the current pads in the background if the rate changed
+    kitBuilder.setTargetSampleRate(sampleRate);
+
+    // Size all processBlock scratch space up front so the audio callback never allocates
+    const int numChannels = jmax(2, getTotalNumInputChannels(), getTotalNumOutputChannels());
+    previewBuffer.setSize(numChannels, samplesPerBlock, false, true, false);
+
+    // Room for the host's events plus a full queue of UI events on either one
+    mainMidiBuffer.ensureSize(4096);
+    previewMidiBuffer.ensureSize(4096);
+
+    previewGain.reset(sampleRate, 0.05);
+    previewGain.setCurrentAndTargetValue(previewGainTarget.load());
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::setSampleStorage(PadSample::Storage newStorage)
+{
+    if (newStorage == samplePool->getStorage())
+        return;
+
+    samplePool->setStorage(newStorage);
+    kitBuilder.rebuild();
+}
+
+String FreesoundAdvancedSamplerAudioProcessor::benchmarkKitLoad()
+{
+    Array<DecodedSamplePool::SampleRequest> requests;
+
+    for (int padIndex = 0; padIndex < SampleKit::numPads && padIndex < currentSoundsArray.size(); ++padIndex)
+    {
+        const auto& sound = currentSoundsArray.getReference(padIndex);
+        if (presetManager.sampleExists(sound.id))
+            requests.add({ sound.id, SampleStore::getSampleFile(currentSessionDownloadLocation, sound.id) });
+    }
+
+    if (requests.isEmpty())
+        return "No pads to load";
+
+    String report = "Kit load, " + String(requests.size()) + " pads:\n";
+    double singleThreadSeconds = 0.0;
+
+    for (int numThreads = 1; numThreads <= SystemStats::getNumCpus(); numThreads *= 2)
+    {
+        const double seconds = samplePool->timeDecode(requests, numThreads);
+
+        if (numThreads == 1)
+            singleThreadSeconds = seconds;
+
+        report << String(numThreads).paddedLeft(' ', 3) << " threads: "
+               << String(seconds * 1000.0, 1) << " ms (x" << String(singleThreadSeconds / seconds, 2) << ")\n";
+    }
+
+    DBG(report);
+    return report;
+}
+
+double FreesoundAdvancedSamplerAudioProcessor::getVoiceRenderNanosPerSample()
+{
+    const int64 ticks = voiceRenderTicks.exchange(0);
+    const int64 numSamples = voiceRenderSamples.exchange(0);
+
+    if (numSamples <= 0)
+        return 0.0;
+
+    return Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / (double)numSamples;
 }
 
 //==============================================================================
@@ -509,11 +827,36 @@ void FreesoundAdvancedSamplerAudioProcessor::loadPluginState(const XmlElement& x
 
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::newSoundsReady(Array<FSSound> sounds, String textQuery, std::vector<juce::StringArray> soundInfo)
+void FreesoundAdvancedSamplerAudioProcessor::newSoundsReady(const Array<FSSound>& sounds, const String& textQuery, const std::vector<juce::StringArray>& soundInfo,
+                                                            const Array<int>& targetPads)
 {
     query = textQuery;
-    soundsArray = soundInfo;
-    currentSoundsArray = sounds; // Store the sounds array
+
+    while (currentSoundsArray.size() < SampleKit::numPads)
+        currentSoundsArray.add(FSSound());
+    soundsArray.resize((size_t)jmax((int)soundsArray.size(), SampleKit::numPads));
+
+    const int numSounds = targetPads.isEmpty() ? sounds.size() : jmin(sounds.size(), targetPads.size());
+
+    for (int i = 0; i < numSounds; ++i)
+    {
+        const int padIndex = targetPads.isEmpty() ? i : targetPads[i];
+
+        if (!isPositiveAndBelow(padIndex, SampleKit::numPads))
+            continue;
+
+        const FSSound& sound = sounds.getReference(i);
+        currentSoundsArray.set(padIndex, sound);
+
+        // Pad data is name, author, license, query, as populatePadsFromMasterSearch() writes it
+        const StringArray info = i < (int)soundInfo.size() ? soundInfo[(size_t)i] : StringArray();
+        StringArray padData;
+        padData.add(info.size() > 0 ? info[0] : sound.name);
+        padData.add(info.size() > 1 ? info[1] : sound.user);
+        padData.add(info.size() > 2 ? info[2] : sound.license);
+        padData.add(textQuery);
+        soundsArray[(size_t)padIndex] = padData;
+    }
 
     // Check if we have an editor with a grid component to handle master search
     if (auto* editor = dynamic_cast<FreesoundAdvancedSamplerAudioProcessorEditor*>(getActiveEditor()))
@@ -535,22 +878,23 @@ void FreesoundAdvancedSamplerAudioProcessor::startDownloads(const Array<FSSound>
     File samplesFolder = presetManager.getSamplesFolder();
     samplesFolder.createDirectory();
 
+    // Store the current download location for this session (now points to samples folder)
+    currentSessionDownloadLocation = samplesFolder;
+
     // Filter out sounds that already exist to avoid re-downloading
-    Array<FSSound> soundsToDownload;
+    Array<FSSound> soundsToDownload, soundsOnDisk;
     for (const auto& sound : sounds)
     {
-        String fileName = "FS_ID_" + sound.id + ".ogg";
-        File audioFile = samplesFolder.getChildFile(fileName);
-
-        if (!audioFile.existsAsFile())
+        if (!presetManager.sampleExists(sound.id))
         {
             soundsToDownload.add(sound);
         }
+        else
+        {
+            soundsOnDisk.add(sound);
+        }
     }
 
-    // Store the current download location for this session (now points to samples folder)
-    currentSessionDownloadLocation = samplesFolder;
-
     // If no new downloads needed, just load existing samples
     if (soundsToDownload.isEmpty())
     {
@@ -564,13 +908,17 @@ void FreesoundAdvancedSamplerAudioProcessor::startDownloads(const Array<FSSound>
         return;
     }
 
+    // Samples already on disk are playable now rather than once the others arrive
+    for (const auto& sound : soundsOnDisk)
+        installDownloadedSound(sound.id, SampleStore::getSampleFile(samplesFolder, sound.id));
+
     // Start downloading only the new samples
     downloadManager.startDownloads(soundsToDownload, samplesFolder, query);
 }
 
 void FreesoundAdvancedSamplerAudioProcessor::cancelDownloads()
 {
-	downloadManager.stopThread(2000);
+	downloadManager.cancelDownloads();
 }
 
 void FreesoundAdvancedSamplerAudioProcessor::downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress)
@@ -596,6 +944,36 @@ void FreesoundAdvancedSamplerAudioProcessor::downloadCompleted(bool success)
     // Only update if this was a preset load or other non-master-search operation
 }
 
+void FreesoundAdvancedSamplerAudioProcessor::downloadFileCompleted(const AudioDownloadManager::FileProgress& file)
+{
+    // Each file goes into its pads as soon as it lands; the full kit is still
+    // rebuilt once the whole batch is done
+    if (!file.failed)
+        installDownloadedSound(file.freesoundId, file.file);
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::BackfillForwarder::downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress)
+{
+    // A kit download owns the progress display until it finishes
+    if (!owner.downloadManager.isDownloading())
+        owner.downloadProgressChanged(progress);
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::BackfillForwarder::downloadCompleted(bool success)
+{
+    if (owner.downloadManager.isDownloading())
+        return;
+
+    owner.downloadListeners.call([success](DownloadListener& l) {
+        l.backfillCompleted(success);
+    });
+}
+
+void FreesoundAdvancedSamplerAudioProcessor::BackfillForwarder::downloadFileCompleted(const AudioDownloadManager::FileProgress& file)
+{
+    owner.downloadFileCompleted(file);
+}
+
 void FreesoundAdvancedSamplerAudioProcessor::addDownloadListener(DownloadListener* listener)
 {
 	downloadListeners.add(listener);
@@ -608,120 +986,129 @@ void FreesoundAdvancedSamplerAudioProcessor::removeDownloadListener(DownloadList
 
 void FreesoundAdvancedSamplerAudioProcessor::setSources()
 {
-    sampler.clearSounds();
-    sampler.clearVoices();
-
-    int poliphony = 16;
-    double maxLength = 0.0; // CHANGED: 0.0 means no length limit
-
-    // Add tracking voices
-    for (int i = 0; i < poliphony; i++) {
-        sampler.addVoice(new TrackingSamplerVoice(*this));
-    }
-
-    // Add a tracking voice for preview sampler instead of regular voice
-    previewSampler.addVoice(new TrackingPreviewSamplerVoice(*this));
-
-    if (audioFormatManager.getNumKnownFormats() == 0) {
-        audioFormatManager.registerBasicFormats();
-    }
+    // Decoding happens on the kit builder thread; the sampler keeps playing the
+    // previous kit until the new one is handed over at the start of a block
+    Array<SampleKitBuilder::PadSource> pads;
+    StringArray padIds;
 
     // Load samples by their actual pad positions
-    for (int padIndex = 0; padIndex < 16; ++padIndex)
+    for (int padIndex = 0; padIndex < SampleKit::numPads; ++padIndex)
     {
         if (padIndex < currentSoundsArray.size() && !currentSoundsArray[padIndex].id.isEmpty())
         {
             const FSSound& sound = currentSoundsArray[padIndex];
 
-            String fileName = "FS_ID_" + sound.id + ".ogg";
-            File audioFile = currentSessionDownloadLocation.getChildFile(fileName);
-
-            if (audioFile.existsAsFile())
-            {
-                std::unique_ptr<AudioFormatReader> reader(audioFormatManager.createReaderFor(audioFile));
-
-                if (reader != nullptr)
-                {
-                    BigInteger notes;
-                    int midiNote = 36 + padIndex;
-                    notes.setBit(midiNote, true);
-
-                    // For sustained playback (samples play until note off):
-                    double attackTime = 0.0;      // Start immediately
-                    double releaseTime = 0.1;     // Short release (100ms fadeout after note off)
-                    double maxSampleLength = 10.0; // No length limit - play full sample
+            File audioFile = SampleStore::getSampleFile(currentSessionDownloadLocation, sound.id);
 
-                    sampler.addSound(new SamplerSound(String(padIndex), *reader, notes, midiNote,
-                                                     attackTime, releaseTime, maxSampleLength));
+            pads.add({ padIndex, sound.id, audioFile });
+            padIds.add(sound.id);
 
-                }
-            }
+            // Loading counts as a use, for the sample store's eviction
+            presetManager.getSampleStore().touch(sound.id);
         }
     }
 
-}
-
-void FreesoundAdvancedSamplerAudioProcessor::addNoteOnToMidiBuffer(int notenumber)
-{
-	MidiMessage message = MidiMessage::noteOn(10, notenumber, (uint8)100);
-	double timestamp = Time::getMillisecondCounterHiRes() * 0.001 - getStartTime();
-	message.setTimeStamp(timestamp);
+    {
+        const ScopedLock sl(loadedSampleIdsLock);
+        loadedSampleIds = padIds;
+    }
 
-	auto sampleNumber = (int)(timestamp * getSampleRate());
-	midiFromEditor.addEvent(message,sampleNumber);
+    kitBuilder.requestBuild(pads);
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::addNoteOffToMidiBuffer(int noteNumber)
+bool FreesoundAdvancedSamplerAudioProcessor::getPinnedSampleIds(StringArray& ids)
 {
-    MidiMessage message = MidiMessage::noteOff(10, noteNumber, (uint8)0);
-    double timestamp = Time::getMillisecondCounterHiRes() * 0.001 - getStartTime();
-    message.setTimeStamp(timestamp);
+    // Eviction thread: only the preset and bookmark files and the lock-guarded
+    // pad list are read here
+    {
+        const ScopedLock sl(loadedSampleIdsLock);
+        ids.addArray(loadedSampleIds);
+    }
 
-    auto sampleNumber = (int)(timestamp * getSampleRate());
-    midiFromEditor.addEvent(message,sampleNumber);
+    return presetManager.getReferencedSampleIds(ids)
+        && bookmarkManager.getBookmarkedSampleIds(ids);
 }
 
-double FreesoundAdvancedSamplerAudioProcessor::getStartTime(){
-	return startTime;
+void FreesoundAdvancedSamplerAudioProcessor::installDownloadedSound(const String& freesoundId, const File& audioFile)
+{
+    for (int padIndex = 0; padIndex < SampleKit::numPads && padIndex < currentSoundsArray.size(); ++padIndex)
+        if (currentSoundsArray.getReference(padIndex).id == freesoundId)
+            kitBuilder.requestPadUpdate({ padIndex, freesoundId, audioFile });
 }
 
-bool FreesoundAdvancedSamplerAudioProcessor::isArrayNotEmpty()
+void FreesoundAdvancedSamplerAudioProcessor::addNoteOnToMidiBuffer(int notenumber)
 {
-	return soundsArray.size() != 0;
+	pushUiEvent(PadEvent::Type::NoteOn, notenumber, (uint8)100);
 }
 
-String FreesoundAdvancedSamplerAudioProcessor::getQuery()
+void FreesoundAdvancedSamplerAudioProcessor::addNoteOffToMidiBuffer(int noteNumber)
 {
-	return query;
+	pushUiEvent(PadEvent::Type::NoteOff, noteNumber, (uint8)0);
 }
 
-std::vector<juce::StringArray> FreesoundAdvancedSamplerAudioProcessor::getData()
+void FreesoundAdvancedSamplerAudioProcessor::pushUiEvent(PadEvent::Type type, int noteNumber, uint8 velocity)
 {
-	return soundsArray;
+	PadEvent event;
+	event.type = type;
+	event.noteNumber = noteNumber;
+	event.velocity = velocity;
+	event.timestampMs = Time::getMillisecondCounterHiRes();
+
+	if (!uiEventQueue.push(event))
+	{
+		DBG("UI event queue full, dropping event for note " + String(noteNumber));
+	}
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::addPlaybackListener(PlaybackListener* listener)
+void FreesoundAdvancedSamplerAudioProcessor::drainUiEvents(int numSamples)
 {
-    playbackListeners.add(listener);
+	// Straight into the scratch buffers reserved in prepareToPlay: the host's
+	// buffer might have to grow, which would allocate on the audio thread
+	const double blockStartMs = Time::getMillisecondCounterHiRes();
+	const double previousBlockStartMs = lastBlockStartMs;
+	const bool alignToHostTime = uiEventTiming.load() == UiEventTiming::HostTimeAligned
+	                             && previousBlockStartMs > 0.0;
+	const double samplesPerMs = getSampleRate() * 0.001;
+	const int lastSample = jmax(0, numSamples - 1);
+
+	uiEventQueue.drain([&](const PadEvent& event)
+	{
+		MidiMessage message;
+		MidiBuffer* target = &mainMidiBuffer;
+
+		switch (event.type)
+		{
+			case PadEvent::Type::NoteOn:       message = MidiMessage::noteOn(10, event.noteNumber, event.velocity); break;
+			case PadEvent::Type::NoteOff:      message = MidiMessage::noteOff(10, event.noteNumber, event.velocity); break;
+			case PadEvent::Type::PreviewStart: message = MidiMessage::noteOn(2, event.noteNumber, event.velocity); target = &previewMidiBuffer; break;
+			case PadEvent::Type::PreviewStop:  message = MidiMessage::noteOff(2, event.noteNumber, event.velocity); target = &previewMidiBuffer; break;
+		}
+
+		// Events pushed while the previous block was rendering are shifted by exactly
+		// one block, so consecutive clicks keep their spacing instead of bunching up
+		int sampleOffset = 0;
+		if (alignToHostTime)
+			sampleOffset = jlimit(0, lastSample, (int)((event.timestampMs - previousBlockStartMs) * samplesPerMs));
+
+		target->addEvent(message, sampleOffset);
+	});
+
+	lastBlockStartMs = blockStartMs;
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::removePlaybackListener(PlaybackListener* listener)
+bool FreesoundAdvancedSamplerAudioProcessor::isArrayNotEmpty()
 {
-    playbackListeners.remove(listener);
+	return soundsArray.size() != 0;
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::notifyNoteStarted(int noteNumber, float velocity)
+String FreesoundAdvancedSamplerAudioProcessor::getQuery()
 {
-    playbackListeners.call([noteNumber, velocity](PlaybackListener& l) {
-        l.noteStarted(noteNumber, velocity);
-    });
+	return query;
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::notifyNoteStopped(int noteNumber)
+std::vector<juce::StringArray> FreesoundAdvancedSamplerAudioProcessor::getData()
 {
-    playbackListeners.call([noteNumber](PlaybackListener& l) {
-        l.noteStopped(noteNumber);
-    });
+	return soundsArray;
 }
 
 bool FreesoundAdvancedSamplerAudioProcessor::saveCurrentAsPreset(const String& name, const String& description, int slotIndex)
@@ -803,10 +1190,6 @@ bool FreesoundAdvancedSamplerAudioProcessor::loadPreset(const File& presetFile,
     soundsArray.clear();
     currentSoundsArray.clear();
 
-    // Also clear the sampler before rebuilding
-    sampler.clearSounds();
-    sampler.clearVoices();
-
     // Update query from slot info
     query = masterQuery;
 
@@ -834,9 +1217,8 @@ bool FreesoundAdvancedSamplerAudioProcessor::loadPreset(const File& presetFile,
         if (padInfo.padIndex < 0 || padInfo.padIndex >= 16)
             continue;
 
-        // Check if sample file exists
-        File sampleFile = presetManager.getSampleFile(padInfo.freesoundId);
-        if (!sampleFile.existsAsFile())
+        // Check the store's index rather than the disk
+        if (!presetManager.sampleExists(padInfo.freesoundId))
         {
             DBG("Missing sample file for ID: " + padInfo.freesoundId + " at pad " + String(padInfo.padIndex));
             continue;
@@ -1283,39 +1665,24 @@ void FreesoundAdvancedSamplerAudioProcessor::loadPreviewSample(const File& audio
     // CRITICAL: Stop any currently playing preview first
     stopPreviewSample();
 
-    // Clear existing preview sounds but keep the tracking voice
-    previewSampler.clearSounds();
-
-    // Store which sample we're about to load
-    currentPreviewFreesoundId = freesoundId;
-
-    // Load the preview sample
-    std::unique_ptr<AudioFormatReader> reader(previewAudioFormatManager.createReaderFor(audioFile));
-    if (reader != nullptr)
-    {
-
-        BigInteger notes;
-        int previewNote = 127; // Use highest MIDI note for preview
-        notes.setBit(previewNote, true);
-
-        // Create the sampler sound with the freesound ID in the name
-        // This is crucial for the tracking voice to identify it
-        String soundName = "preview_" + freesoundId;
+    // Usually already decoded for a pad or an earlier preview
+    auto sample = samplePool->getSample(freesoundId, audioFile,
+                                        isResamplingOnLoad() ? getSampleRate() : 0.0);
 
-        double maxLength = 10.0;
-        double attackTime = 0.0;
-        double releaseTime = 0.1;
-
-        auto* samplerSound = new SamplerSound(soundName, *reader, notes, previewNote,
-                                             attackTime, releaseTime, maxLength);
-
-        previewSampler.addSound(samplerSound);
-
-    }
-    else
+    if (sample == nullptr)
     {
         currentPreviewFreesoundId = ""; // Clear on failure
+        return;
     }
+
+    // Store which sample we're about to load
+    currentPreviewFreesoundId = freesoundId;
+    presetManager.getSampleStore().touch(freesoundId);
+
+    // Swapped in at the start of the next block, before the play event is handled
+    SampleKit::Ptr previewKit = new SampleKit();
+    previewKit->setPad(0, sample);
+    previewKitExchange.publish(previewKit);
 }
 
 void FreesoundAdvancedSamplerAudioProcessor::playPreviewSample()
@@ -1327,20 +1694,8 @@ void FreesoundAdvancedSamplerAudioProcessor::playPreviewSample()
         return;
     }
 
-    if (previewSampler.getNumSounds() == 0)
-    {
-        DBG("  - No sounds in preview sampler, aborting");
-        return;
-    }
-
-    // Trigger the preview sample
-    int previewNote = 127;
-    MidiMessage message = MidiMessage::noteOn(2, previewNote, (uint8)100); // Channel 2 for preview
-    double timestamp = Time::getMillisecondCounterHiRes() * 0.001 - getStartTime();
-    message.setTimeStamp(timestamp);
-
-    auto sampleNumber = (int)(timestamp * getSampleRate());
-    midiFromEditor.addEvent(message, sampleNumber);
+    // Trigger the preview sample (rendered on MIDI channel 2)
+    pushUiEvent(PadEvent::Type::PreviewStart, previewNote, (uint8)100);
 
 }
 
@@ -1348,56 +1703,7 @@ void FreesoundAdvancedSamplerAudioProcessor::stopPreviewSample()
 {
     // Send note off for preview - do this even if currentPreviewFreesoundId is empty
     // to ensure any stuck notes are released
-    int previewNote = 127;
-    MidiMessage message = MidiMessage::noteOff(2, previewNote, (uint8)0);
-    double timestamp = Time::getMillisecondCounterHiRes() * 0.001 - getStartTime();
-    message.setTimeStamp(timestamp);
-
-    auto sampleNumber = (int)(timestamp * getSampleRate());
-    midiFromEditor.addEvent(message, sampleNumber);
-
-    // Don't clear currentPreviewFreesoundId here - let the voice handle it
-}
-
-void FreesoundAdvancedSamplerAudioProcessor::notifyPreviewStarted(const String& freesoundId)
-{
-    currentPreviewFreesoundId = freesoundId;
-
-    previewPlaybackListeners.call([freesoundId](PreviewPlaybackListener& l) {
-        l.previewStarted(freesoundId);
-    });
-}
-
-void FreesoundAdvancedSamplerAudioProcessor::notifyPreviewStopped(const String& freesoundId)
-{
-    previewPlaybackListeners.call([freesoundId](PreviewPlaybackListener& l) {
-        l.previewStopped(freesoundId);
-    });
-
-    // Clear the current preview ID after notifying listeners
-    if (currentPreviewFreesoundId == freesoundId)
-    {
-        currentPreviewFreesoundId = "";
-    }
-}
-
-void FreesoundAdvancedSamplerAudioProcessor::notifyPreviewPlayheadPositionChanged(const String& freesoundId, float position)
-{
-    // Don't log this one as it's called frequently
-    previewPlaybackListeners.call([freesoundId, position](PreviewPlaybackListener& l) {
-        l.previewPlayheadPositionChanged(freesoundId, position);
-    });
-}
-
-// Add these listener management methods:
-void FreesoundAdvancedSamplerAudioProcessor::addPreviewPlaybackListener(PreviewPlaybackListener* listener)
-{
-    previewPlaybackListeners.add(listener);
-}
-
-void FreesoundAdvancedSamplerAudioProcessor::removePreviewPlaybackListener(PreviewPlaybackListener* listener)
-{
-    previewPlaybackListeners.remove(listener);
+    pushUiEvent(PadEvent::Type::PreviewStop, previewNote, (uint8)0);
 }
 
 //==============================================================================
@@ -1407,13 +1713,6 @@ AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new FreesoundAdvancedSamplerAudioProcessor();
 }
 
-void FreesoundAdvancedSamplerAudioProcessor::notifyPlayheadPositionChanged(int noteNumber, float position)
-{
-    playbackListeners.call([noteNumber, position](PlaybackListener& l) {
-        l.playheadPositionChanged(noteNumber, position);
-    });
-}
-
 // Add these method implementations to your PluginProcessor.cpp file:
 
 Array<FSSound> FreesoundAdvancedSamplerAudioProcessor::getCurrentSounds()
@@ -15,6 +15,14 @@
 #include "AudioDownloadManager.h"
 #include "PresetManager.h"
 #include "BookmarkManager.h"
+#include "PadEventQueue.h"
+#include "SampleKit.h"
+#include "SampleKitBuilder.h"
+#include "DecodedSamplePool.h"
+#include "PadSynthesiser.h"
+#include "PadStream.h"
+#include "PlaybackState.h"
+#include "PadVoiceKernel.h"
 
 using namespace juce;
 
@@ -65,21 +73,79 @@ public:
     //==============================================================================
     File tmpDownloadLocation;
     File currentSessionDownloadLocation; // NEW: Current session's download folder
-	void newSoundsReady(Array<FSSound> sounds, String textQuery, std::vector<juce::StringArray> soundInfo);
+	// Sound k goes to pad targetPads[k] (pad k when there are no targets), and
+	// the other pads keep their samples, so files installed as they arrive land
+	// on the pads the search was for
+	void newSoundsReady(const Array<FSSound>& sounds, const String& textQuery, const std::vector<juce::StringArray>& soundInfo,
+	                    const Array<int>& targetPads = {});
 
 
 	// Add these methods to public section
 	void loadPreviewSample(const File& audioFile, const String& freesoundId);
 	void playPreviewSample();
 	void stopPreviewSample();
+	void setPreviewGain(float newGain) { previewGainTarget.store(jlimit(0.0f, 1.0f, newGain)); }
 
 	// main sampler methods for sample pads in 4x4 grid
 	void setSources();
+	// Makes the pads using this sound playable straight away, without waiting
+	// for the rest of the kit
+	void installDownloadedSound(const String& freesoundId, const File& audioFile);
 	void addNoteOnToMidiBuffer(int notenumber);	// for adding notes from
 	void addNoteOffToMidiBuffer(int noteNumber);
 
+	// Voice pool settings for the 4x4 grid (the pool itself never grows)
+	void setPolyphony(int numVoices) { sampler.setPolyphonyLimit(numVoices); }
+	int getPolyphony() const { return sampler.getPolyphonyLimit(); }
+	void setVoiceStealing(PadSynthesiser::VoiceStealing policy) { sampler.setVoiceStealing(policy); }
+	PadSynthesiser::VoiceStealing getVoiceStealing() const { return sampler.getVoiceStealing(); }
+
+	// Resample short pads to the host rate when loading them, so they play as a
+	// straight copy at their root note (on by default)
+	void setResampleOnLoad(bool shouldResample) { kitBuilder.setResampleOnLoad(shouldResample); }
+	bool isResamplingOnLoad() const { return kitBuilder.isResamplingOnLoad(); }
+
+	// Opt-in 16-bit storage for decoded pad audio, which halves its memory. Applies
+	// to every instance, since they share decoded sounds; the current kit is
+	// rebuilt in the new format.
+	void setSampleStorage(PadSample::Storage newStorage);
+	PadSample::Storage getSampleStorage() const { return samplePool->getStorage(); }
+
+	// Pad decodes run as parallel jobs, up to this many at once per kit load. Like
+	// the storage format this is shared by every instance.
+	void setKitLoadConcurrency(int numThreads) { samplePool->setDecodeConcurrency(numThreads); }
+	int getKitLoadConcurrency() const { return samplePool->getDecodeConcurrency(); }
+	double getLastKitLoadSeconds() const { return kitBuilder.getLastBuildSeconds(); }
+
+	// Decodes the current pads from scratch with 1, 2, 4... threads and returns
+	// a report of the time each took. Blocks for a while, so call it from a
+	// background thread.
+	String benchmarkKitLoad();
+
+	// Disk quota for the shared samples folder, 0 for no limit. It's kept in the
+	// folder's index, so it applies to every instance on this machine. Samples
+	// used by presets, bookmarks or loaded pads are never evicted.
+	void setSampleCacheQuota(int64 bytes) { presetManager.getSampleStore().setQuota(bytes); }
+	int64 getSampleCacheQuota() { return presetManager.getSampleStore().getQuota(); }
+	int64 getSampleCacheSize() { return presetManager.getSampleStore().getTotalBytes(); }
+
+	// Interpolation used by notes started from now on (not needed for pads at root rate)
+	void setInterpolation(PadVoiceKernel::Interpolation newInterpolation) { voiceInterpolation.store(newInterpolation); }
+	PadVoiceKernel::Interpolation getInterpolation() const { return voiceInterpolation.load(); }
+
+	// Average cost of one voice rendering one output frame since the last call,
+	// in nanoseconds, or 0 if nothing played. Any thread.
+	double getVoiceRenderNanosPerSample();
+
+	// How UI triggers are placed inside the next audio block
+	enum class UiEventTiming
+	{
+		Immediate,        // Always at sample offset 0 (lowest latency)
+		HostTimeAligned   // Keeps the relative timing of the clicks, one block late
+	};
+	void setUiEventTiming(UiEventTiming timing) { uiEventTiming.store(timing); }
+	UiEventTiming getUiEventTiming() const { return uiEventTiming.load(); }
 
-	double getStartTime();
 	bool isArrayNotEmpty();
 	String getQuery();
 	std::vector<juce::StringArray> getData();
@@ -93,6 +159,10 @@ public:
     void cancelDownloads();
     AudioDownloadManager& getDownloadManager() { return downloadManager; }
 
+    // For fetching samples that aren't meant to replace the current kit, such as
+    // a preset bank's missing samples. Runs alongside the main downloads.
+    AudioDownloadManager& getBackfillDownloadManager() { return backfillDownloadManager; }
+
     // README generation
     void generateReadmeFile(const Array<FSSound>& sounds, const std::vector<StringArray>& soundInfo, const String& searchQuery);
 	void updateReadmeFile();
@@ -100,6 +170,7 @@ public:
     // AudioDownloadManager::Listener implementation
     void downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress) override;
     void downloadCompleted(bool success) override;
+    void downloadFileCompleted(const AudioDownloadManager::FileProgress& file) override;
 
     // For editor to listen to download events
     class DownloadListener
@@ -108,36 +179,17 @@ public:
         virtual ~DownloadListener() = default;
         virtual void downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress) = 0;
         virtual void downloadCompleted(bool success) = 0;
+
+        // Background downloads (a preset's missing samples) that don't change the kit
+        virtual void backfillCompleted(bool success) { ignoreUnused(success); }
     };
 
     void addDownloadListener(DownloadListener* listener);
     void removeDownloadListener(DownloadListener* listener);
 
-    // Playback listener for visual feedback on 4x4 grid
-    class PlaybackListener
-    {
-    public:
-        virtual ~PlaybackListener() = default;
-        virtual void noteStarted(int noteNumber, float velocity) = 0;
-        virtual void noteStopped(int noteNumber) = 0;
-        virtual void playheadPositionChanged(int noteNumber, float position) = 0;
-    };
-
-    void addPlaybackListener(PlaybackListener* listener);
-    void removePlaybackListener(PlaybackListener* listener);
-
-	// Preview playback listener for preview sample visual feedback
-	class PreviewPlaybackListener
-	{
-	public:
-		virtual ~PreviewPlaybackListener() = default;
-		virtual void previewStarted(const String& freesoundId) = 0;
-		virtual void previewStopped(const String& freesoundId) = 0;
-		virtual void previewPlayheadPositionChanged(const String& freesoundId, float position) = 0;
-	};
-
-	void addPreviewPlaybackListener(PreviewPlaybackListener* listener);
-	void removePreviewPlaybackListener(PreviewPlaybackListener* listener);
+    // Playback state for visual feedback on the 4x4 grid and the preview pads.
+    // Written by the audio thread, polled by the editor once per frame.
+    const PlaybackStateBoard& getPlaybackState() const { return playbackState; }
 
 
 	static String cleanFilename(const String& input)
@@ -194,78 +246,160 @@ private:
 	bool presetPanelExpandedState = false;
 	bool bookmarkPanelExpandedState = false;  // ADD THIS
 
-    // Enhanced sampler voice class for playback tracking
-    class TrackingSamplerVoice : public SamplerVoice
+    // Pad voice that plays from the current SampleKit, with playback tracking
+    class TrackingSamplerVoice : public SynthesiserVoice
     {
     public:
         TrackingSamplerVoice(FreesoundAdvancedSamplerAudioProcessor& owner);
 
+        bool canPlaySound(SynthesiserSound*) override;
         void startNote(int midiNoteNumber, float velocity, SynthesiserSound*, int currentPitchWheelPosition) override;
         void stopNote(float velocity, bool allowTailOff) override;
+        void pitchWheelMoved(int newValue) override {}
+        void controllerMoved(int controllerNumber, int newValue) override {}
         void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
 
-    private:
+    protected:
+        // Where the voice finds its audio, and which playback state slot it writes
+        virtual SampleKit* getCurrentKit() { return processor.audioThreadKit; }
+        virtual int getPadIndexForNote(int midiNoteNumber) { return midiNoteNumber - SampleKit::firstMidiNote; }
+        virtual int getStateSlotForNote(int midiNoteNumber) { return getPadIndexForNote(midiNoteNumber); }
+
         FreesoundAdvancedSamplerAudioProcessor& processor;
-        int currentNoteNumber = -1;
+        PadSample* playingSample = nullptr;
+
+    private:
+        void finishNote();
+        void reportStopped();
+        void fillStreamWindow(int64 firstFrame, int64 lastFrame);
+        void gatherFrames(int64 firstFrame, int numFrames, int numChannels);
+        void fillEnvelope(int numSamples);
+        void addToOutput(const float* left, const float* right, float* outL, float* outR, int numSamples);
+        int renderInterpolated(float* outL, float* outR, int numSamples);
+        int renderAtRootRate(float* outL, float* outR, int numSamples);
+
+        int stateSlot = -1; // PlaybackStateBoard slot while the key is held, else -1
         double samplePosition = 0.0;
         double sampleLength = 0.0;
+
+        // The voice keeps its kit alive until the note ends, so swapping kits
+        // mid-note never pulls the audio out from under it
+        SampleKit::Ptr playingKit;
+        double pitchRatio = 1.0;
+        float gain = 0.0f;
+        ADSR adsr;
+        PadVoiceKernel::Interpolation interpolation = PadVoiceKernel::Interpolation::Linear;
+
+        // Frames past the preloaded head come from the stream via a small
+        // window, so interpolation can look one frame ahead
+        static constexpr int streamWindowSize = 4096;
+        PadStream stream;
+        AudioBuffer<float> streamWindow { 2, streamWindowSize };
+        int64 windowStart = 0;
+        int windowFilled = 0;
+
+        // Blocks are rendered in chunks: source frames are gathered into staging,
+        // interpolated into rendered, then mixed in with the envelope
+        static constexpr int renderChunkSize = 256;
+        AudioBuffer<float> staging { 2, streamWindowSize };
+        AudioBuffer<float> rendered { 2, renderChunkSize };
+        AudioBuffer<float> envelope { 1, renderChunkSize };
     };
 
-	// Enhanced preview sampler voice class for playback tracking of 4x4 Grid and Preview Samples
-	class TrackingPreviewSamplerVoice : public SamplerVoice
+	// Preview voice: plays the one-pad preview kit and reports in the preview slot
+	class TrackingPreviewSamplerVoice : public TrackingSamplerVoice
 	{
 	public:
 		TrackingPreviewSamplerVoice(FreesoundAdvancedSamplerAudioProcessor& owner);
 
-		void startNote(int midiNoteNumber, float velocity, SynthesiserSound*, int currentPitchWheelPosition) override;
-		void stopNote(float velocity, bool allowTailOff) override;
-		void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
-
-	private:
-		FreesoundAdvancedSamplerAudioProcessor& processor;
-		String currentFreesoundId;
-		double samplePosition = 0.0;
-		double sampleLength = 0.0;
+	protected:
+		SampleKit* getCurrentKit() override { return processor.audioThreadPreviewKit; }
+		int getPadIndexForNote(int) override { return 0; }
+		int getStateSlotForNote(int) override { return PlaybackStateBoard::previewSlot; }
 	};
 
-	ListenerList<PreviewPlaybackListener> previewPlaybackListeners;
-	String currentPreviewFreesoundId; // Track which sample is currently previewing
+	String currentPreviewFreesoundId; // Track which sample is currently previewing (message thread)
 
-	// Preview notification methods
-	void notifyPreviewStarted(const String& freesoundId);
-	void notifyPreviewStopped(const String& freesoundId);
-	void notifyPreviewPlayheadPositionChanged(const String& freesoundId, float position);
+	PlaybackStateBoard playbackState;
 
     AudioDownloadManager downloadManager;
+    AudioDownloadManager backfillDownloadManager;
     ListenerList<DownloadListener> downloadListeners;
-    ListenerList<PlaybackListener> playbackListeners; // NEW
 
-	Synthesiser sampler;
-	AudioFormatManager audioFormatManager;
-	MidiBuffer midiFromEditor;
-	long midicounter;
-	double startTime;
+	// Passes backfill progress on to downloadListeners while the main downloads
+	// are idle. Its files are installed one by one, so the end of the batch is
+	// only reported as backfillCompleted(), never as a kit download finishing.
+	struct BackfillForwarder : public AudioDownloadManager::Listener
+	{
+		explicit BackfillForwarder(FreesoundAdvancedSamplerAudioProcessor& p) : owner(p) {}
+		void downloadProgressChanged(const AudioDownloadManager::DownloadProgress& progress) override;
+		void downloadCompleted(bool success) override;
+		void downloadFileCompleted(const AudioDownloadManager::FileProgress& file) override;
+
+		FreesoundAdvancedSamplerAudioProcessor& owner;
+	};
+
+	BackfillForwarder backfillForwarder { *this };
+
+	PadSynthesiser sampler;
+	std::atomic<PadVoiceKernel::Interpolation> voiceInterpolation { PadVoiceKernel::Interpolation::Linear };
+
+	// Voice render timing, added to by the voices on the audio thread
+	std::atomic<int64> voiceRenderTicks { 0 };
+	std::atomic<int64> voiceRenderSamples { 0 };
+	void addVoiceRenderTime(int64 ticks, int numSamples)
+	{
+		voiceRenderTicks.fetch_add(ticks, std::memory_order_relaxed);
+		voiceRenderSamples.fetch_add(numSamples, std::memory_order_relaxed);
+	}
+
+	// Pad audio is decoded by kitBuilder and swapped in whole by kitExchange
+	SampleKitExchange kitExchange;
+	SampleKitBuilder kitBuilder { kitExchange };
+	SampleKit* audioThreadKit = nullptr; // audio thread only, refreshed every block
+
+	// UI -> audio thread triggers (pads, keyboard, previews)
+	PadEventQueue uiEventQueue;
+	std::atomic<UiEventTiming> uiEventTiming { UiEventTiming::Immediate };
+	double lastBlockStartMs = 0.0; // audio thread only
+	void pushUiEvent(PadEvent::Type type, int noteNumber, uint8 velocity);
+	void drainUiEvents(int numSamples);
+
 	String query;
 	std::vector<juce::StringArray> soundsArray;
     Array<FSSound> currentSoundsArray; // NEW: Store current sounds
 
 	// Add dedicated preview sampler (runs in parallel)
+	// It plays a one-pad kit that is swapped in the same way as the grid's kit
 	Synthesiser previewSampler;
-	AudioFormatManager previewAudioFormatManager;
+	SampleKitExchange previewKitExchange;
+	SampleKit* audioThreadPreviewKit = nullptr; // audio thread only
+	SharedResourcePointer<DecodedSamplePool> samplePool;
+	static constexpr int previewNote = 127; // Use highest MIDI note for preview
+
+	// Scratch buffers for processBlock, sized in prepareToPlay and reused every block
+	MidiBuffer mainMidiBuffer;
+	MidiBuffer previewMidiBuffer;
+	AudioBuffer<float> previewBuffer;
+	SmoothedValue<float> previewGain;
+	std::atomic<float> previewGainTarget { 0.6f }; // 60% volume for preview
 
-    // NEW: Methods for playback tracking
-    void notifyNoteStarted(int noteNumber, float velocity);
-    void notifyNoteStopped(int noteNumber);
-    void notifyPlayheadPositionChanged(int noteNumber, float position);
 
 	PresetManager presetManager;
 
 	BookmarkManager bookmarkManager; // Add this
 
+	// What the pads were last loaded from, read by the sample store's eviction
+	// thread when it works out what to keep
+	bool getPinnedSampleIds(StringArray& ids);
+	StringArray loadedSampleIds;
+	CriticalSection loadedSampleIdsLock;
+
 	void savePluginState(XmlElement& xml);
 	void loadPluginState(const XmlElement& xml);
 
     friend class TrackingSamplerVoice;
+    friend class TrackingPreviewSamplerVoice;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FreesoundAdvancedSamplerAudioProcessor)
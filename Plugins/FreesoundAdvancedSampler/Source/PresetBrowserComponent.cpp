@@ -398,7 +398,11 @@ PresetBrowserComponent::PresetBrowserComponent()
     addAndMakeVisible(addBankButton);
 }
 
-PresetBrowserComponent::~PresetBrowserComponent() {}
+PresetBrowserComponent::~PresetBrowserComponent()
+{
+    // Its continuation captures this
+    missingSoundsFetch.cancel();
+}
 
 void PresetBrowserComponent::paint(Graphics& g)
 {
@@ -976,8 +980,7 @@ void PresetBrowserComponent::handleSampleCheckClicked(PresetListItem* item)
                 // Add to unique samples list
                 allUniqueSampleIds.addIfNotAlreadyThere(padInfo.freesoundId);
 
-                File sampleFile = processor->getPresetManager().getSampleFile(padInfo.freesoundId);
-                if (!sampleFile.existsAsFile())
+                if (!processor->getPresetManager().sampleExists(padInfo.freesoundId))
                 {
                     // For missing samples, add unique IDs for download
                     uniqueMissingSampleIds.addIfNotAlreadyThere(padInfo.freesoundId);
@@ -1046,31 +1049,42 @@ void PresetBrowserComponent::downloadMissingSamples(const Array<PadInfo>& missin
         uniqueMissingIds.addIfNotAlreadyThere(padInfo.freesoundId);
     }
 
-    // We need to fetch the missing sounds from Freesound API to get complete data including previews
-    Array<FSSound> soundsToDownload;
+    // We need to fetch the missing sounds from Freesound API to get complete data including previews.
+    // That's one request per sound, so it runs on the request pool.
     FreesoundClient client(FREESOUND_API_KEY);
 
-    for (const String& freesoundId : uniqueMissingIds)
+    missingSoundsFetch.cancel();
+    missingSoundsFetch = client.runAsync<Array<FSSound>>([uniqueMissingIds](FreesoundClient& poolClient)
     {
-        try
+        Array<FSSound> sounds;
+
+        for (const String& freesoundId : uniqueMissingIds)
         {
+            if (FSCancellationToken::getCurrent() != nullptr && FSCancellationToken::getCurrent()->isCancelled())
+                break;
+
             // Fetch the complete sound data from Freesound API including previews
-            FSSound sound = client.getSound(freesoundId, "id,name,username,license,previews,duration,filesize");
+            FSSound sound = poolClient.getSound(freesoundId, "id,name,username,license,previews,duration,filesize");
 
             if (!sound.id.isEmpty())
-            {
-                soundsToDownload.add(sound);
-            }
+                sounds.add(sound);
             else
-            {
                 DBG("Failed to fetch sound data for ID: " + freesoundId);
-            }
         }
-        catch (const std::exception& e)
-        {
-            DBG("Error fetching sound " + freesoundId + ": " + String(e.what()));
-        }
-    }
+
+        return sounds;
+    });
+
+    missingSoundsFetch.then([this](const Array<FSSound>& soundsToDownload)
+    {
+        startMissingSamplesDownload(soundsToDownload);
+    });
+}
+
+void PresetBrowserComponent::startMissingSamplesDownload(const Array<FSSound>& soundsToDownload)
+{
+    if (!processor)
+        return;
 
     if (soundsToDownload.isEmpty())
     {
@@ -1080,8 +1094,8 @@ void PresetBrowserComponent::downloadMissingSamples(const Array<PadInfo>& missin
         return;
     }
 
-    // Start download using processor's download system
-    processor->getDownloadManager().startDownloads(
+    // Start download alongside whatever the grid is fetching
+    processor->getBackfillDownloadManager().startDownloads(
         soundsToDownload,
         processor->getPresetManager().getSamplesFolder(),
         "Missing samples download"
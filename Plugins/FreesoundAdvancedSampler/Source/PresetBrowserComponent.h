@@ -144,6 +144,8 @@ private:
 
     void handleSampleCheckClicked(PresetListItem* item);
     void downloadMissingSamples(const Array<PadInfo>& missingPadInfos);
+    void startMissingSamplesDownload(const Array<FSSound>& soundsToDownload);
+    FSFuture<Array<FSSound>> missingSoundsFetch;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBrowserComponent)
 };
\ No newline at end of file
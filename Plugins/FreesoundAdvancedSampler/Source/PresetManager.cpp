@@ -17,6 +17,7 @@ PresetManager::PresetManager(const File& baseDirectory)
     , activeSlotIndex(-1)
 {
     ensureDirectoriesExist();
+    sampleStore->open(samplesFolder);
 }
 
 PresetManager::~PresetManager()
@@ -397,10 +398,9 @@ bool PresetManager::loadPreset(const File& presetFile, int slotIndex, Array<PadI
         }
 
         // Check if the sample file exists
-        File sampleFile = getSampleFile(padInfo.freesoundId);
-        if (!sampleFile.existsAsFile())
+        if (!sampleExists(padInfo.freesoundId))
         {
-            // DBG("Sample file does not exist: " + sampleFile.getFullPathName() +
+            // DBG("Sample file does not exist: " + getSampleFile(padInfo.freesoundId).getFullPathName() +
                 // " for freesoundId: " + padInfo.freesoundId);
             // Continue anyway - the processor will handle missing files
         }
@@ -586,8 +586,7 @@ PresetSlotInfo PresetManager::getSlotInfo(const File& presetFile, int slotIndex)
 
 bool PresetManager::sampleExists(const String& freesoundId) const
 {
-    String fileName = "FS_ID_" + freesoundId + ".ogg";
-    return samplesFolder.getChildFile(fileName).existsAsFile();
+    return freesoundId.isNotEmpty() && sampleStore->contains(freesoundId);
 }
 
 File PresetManager::getSampleFile(const String& freesoundId) const
@@ -595,9 +594,7 @@ File PresetManager::getSampleFile(const String& freesoundId) const
     if (freesoundId.isEmpty())
         return File();
 
-    // Use the standard naming convention: FS_ID_XXXX.ogg
-    String fileName = "FS_ID_" + freesoundId + ".ogg";
-    File sampleFile = samplesFolder.getChildFile(fileName);
+    File sampleFile = SampleStore::getSampleFile(samplesFolder, freesoundId);
 
     // DBG("Looking for sample file: " + sampleFile.getFullPathName());
     return sampleFile;
@@ -614,33 +611,48 @@ String PresetManager::generatePresetName(const String& searchQuery) const
     return baseName + "_" + dateStr;
 }
 
-void PresetManager::cleanupUnusedSamples()
+bool PresetManager::getReferencedSampleIds(StringArray& ids) const
 {
-    // Get all preset files and collect referenced sample IDs
-    StringArray referencedIds;
+    DirectoryIterator iter(presetsFolder, false, "*.json");
 
-    Array<PresetInfo> presets = getAvailablePresets();
-    for (const auto& presetInfo : presets)
+    while (iter.next())
     {
+        var parsedJson = JSON::parse(iter.getFile().loadFileAsString());
+        if (!parsedJson.isObject())
+            return false;
+
         // Check all slots
         for (int slotIndex = 0; slotIndex < MAX_SLOTS; ++slotIndex)
         {
-            Array<PadInfo> padInfos;
-            if (loadPreset(presetInfo.presetFile, slotIndex, padInfos))
+            var samplesVar = parsedJson.getProperty("slot_" + String(slotIndex), var()).getProperty("samples", var());
+
+            if (auto* samplesArray = samplesVar.getArray())
             {
-                for (const auto& padInfo : padInfos)
+                for (const auto& sampleVar : *samplesArray)
                 {
-                    if (padInfo.freesoundId.isNotEmpty())
-                    {
-                        referencedIds.addIfNotAlreadyThere(padInfo.freesoundId);
-                    }
+                    const String freesoundId = sampleVar.getProperty("freesound_id", "");
+
+                    if (freesoundId.isNotEmpty())
+                        ids.addIfNotAlreadyThere(freesoundId);
                 }
             }
         }
     }
 
+    return true;
+}
+
+void PresetManager::cleanupUnusedSamples()
+{
+    // Get all preset files and collect referenced sample IDs
+    StringArray referencedIds;
+
+    // A preset we can't read could be using any of them
+    if (!getReferencedSampleIds(referencedIds))
+        return;
+
     // Scan samples folder and delete unreferenced files
-    DirectoryIterator iter(samplesFolder, false, "FS_ID_*.ogg");
+    DirectoryIterator iter(samplesFolder, true, "FS_ID_*.ogg");
 
     while (iter.next())
     {
@@ -655,6 +667,7 @@ void PresetManager::cleanupUnusedSamples()
             if (!referencedIds.contains(freesoundId))
             {
                 sampleFile.deleteFile();
+                sampleStore->remove(freesoundId);
             }
         }
     }
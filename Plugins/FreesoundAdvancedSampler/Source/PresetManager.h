@@ -12,6 +12,7 @@
 
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
 #include "FreesoundAPI/FreesoundAPI.h"
+#include "SampleStore.h"
 
 struct PresetSlotInfo
 {
@@ -82,13 +83,19 @@ public:
     // File management
     File getSamplesFolder() const { return samplesFolder; }
     File getPresetsFolder() const { return presetsFolder; }
-    bool sampleExists(const String& freesoundId) const;
+    bool sampleExists(const String& freesoundId) const; // index lookup, doesn't touch the disk
     File getSampleFile(const String& freesoundId) const;
+    SampleStore& getSampleStore() { return *sampleStore; }
 
     // Utilities
     String generatePresetName(const String& searchQuery) const;
     void cleanupUnusedSamples(); // Remove samples not referenced by any preset
 
+    // Adds the sample IDs used by any slot of any preset. Returns false if a
+    // preset file couldn't be read, e.g. because it's being saved. Only reads
+    // the preset files, so it's safe to call from a background thread.
+    bool getReferencedSampleIds(StringArray& ids) const;
+
     // Active preset tracking
     void setActivePreset(const File& presetFile, int slotIndex);
     File getActivePresetFile() const { return activePresetFile; }
@@ -99,6 +106,7 @@ private:
     File baseDirectory;
     File samplesFolder;
     File presetsFolder;
+    SharedResourcePointer<SampleStore> sampleStore;
 
     // Active preset tracking
     File activePresetFile;
@@ -1,4 +1,5 @@
 #include "SampleCollectionManager.h"
+#include "SampleStore.h"
 
 //==============================================================================
 // SampleMetadata Implementation
@@ -340,7 +341,7 @@ Array<SampleMetadata> SampleCollectionManager::searchSamples(const String& searc
 
 File SampleCollectionManager::getSampleFile(const String& freesoundId) const
 {
-    return samplesFolder.getChildFile("FS_ID_" + freesoundId + ".ogg");
+    return SampleStore::getSampleFile(samplesFolder, freesoundId);
 }
 
 bool SampleCollectionManager::sampleFileExists(const String& freesoundId) const
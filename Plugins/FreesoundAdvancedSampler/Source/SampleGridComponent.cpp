@@ -21,8 +21,7 @@ SamplePad::SamplePad(int index, PadMode mode)
     : padIndex(index)
     , padMode(mode)
     , processor(nullptr)
-    , audioThumbnailCache(5)
-    , audioThumbnail(512, formatManager, audioThumbnailCache)
+    , audioThumbnail(512, formatManager, *audioThumbnailCache)
     , freesoundId(String())
     , licenseType(String())
     , padQuery(String())
@@ -313,6 +312,10 @@ void SamplePad::resized()
 
 void SamplePad::mouseDown(const MouseEvent& event)
 {
+    // Someone clicking a pad that's still waiting for its sound wants it next
+    if (auto* gridComponent = findParentComponentOfClass<SampleGridComponent>())
+        gridComponent->boostPadDownload(padIndex);
+
     // Don't allow interaction while downloading
     if (isDownloading)
         return;
@@ -428,7 +431,6 @@ void SamplePad::mouseUp(const MouseEvent& event)
         int noteNumber = padIndex + 36;
         processor->addNoteOffToMidiBuffer(noteNumber);
         setIsPlaying(false);
-        processorSampleRate = processor->getSampleRate();
     }
 
     // Reset cursor
@@ -528,10 +530,16 @@ void SamplePad::mouseDoubleClick(const MouseEvent& event)
 void SamplePad::mouseEnter(const MouseEvent& event)
 {
     Component::mouseEnter(event);
+
+    if (auto* gridComponent = findParentComponentOfClass<SampleGridComponent>())
+        gridComponent->setHoveredPad(padIndex);
 }
 
 void SamplePad::mouseExit(const MouseEvent& event)
 {
+    if (auto* gridComponent = findParentComponentOfClass<SampleGridComponent>())
+        gridComponent->setHoveredPad(-1);
+
     // Preview mode: Stop preview if mouse exits while playing
     if (padMode == PadMode::Preview && (previewRequested || isPreviewPlaying))
     {
@@ -682,23 +690,23 @@ void SamplePad::setSample(const File& audioFile, const String& name, const Strin
 
 void SamplePad::setPlayheadPosition(float position)
 {
-    // Adjust position using fileSourceSampleRate and processorSampleRate
-    position = (position * fileSourceSampleRate) / processorSampleRate;
+    position = jlimit(0.0f, 1.0f, position);
 
-    MessageManager::callAsync([this, position]()
-    {
-        playheadPosition = jlimit(0.0f, 1.0f, position);
-        repaint();
-    });
+    // Polled every frame, so only repaint when something actually moved
+    if (position == playheadPosition)
+        return;
+
+    playheadPosition = position;
+    repaint();
 }
 
 void SamplePad::setIsPlaying(bool playing)
 {
-    MessageManager::callAsync([this, playing]()
-    {
-        isPlaying = playing;
-        repaint();
-    });
+    if (playing == isPlaying)
+        return;
+
+    isPlaying = playing;
+    repaint();
 }
 
 void SamplePad::setProcessor(FreesoundAdvancedSamplerAudioProcessor* p)
@@ -834,23 +842,23 @@ void SamplePad::setPreviewPlaying(bool playing)
     if (padMode != PadMode::Preview)
         return;
 
-    MessageManager::callAsync([this, playing]()
-    {
-        isPreviewPlaying = playing;
+    if (playing == isPreviewPlaying)
+        return;
 
-        // Update pad color based on playing state
-        if (playing)
-        {
-            padColour = defaultColour.withAlpha(0.5f);
-        }
-        else
-        {
-            padColour = defaultColour.withAlpha(0.2f);
-            previewPlayheadPosition = 0.0f;
-        }
+    isPreviewPlaying = playing;
 
-        repaint();
-    });
+    // Update pad color based on playing state
+    if (playing)
+    {
+        padColour = defaultColour.withAlpha(0.5f);
+    }
+    else
+    {
+        padColour = defaultColour.withAlpha(0.2f);
+        previewPlayheadPosition = 0.0f;
+    }
+
+    repaint();
 }
 
 void SamplePad::setPreviewPlayheadPosition(float position)
@@ -858,14 +866,13 @@ void SamplePad::setPreviewPlayheadPosition(float position)
     if (padMode != PadMode::Preview)
         return;
 
-    // Adjust position using fileSourceSampleRate and processorSampleRate
-    position = (position * fileSourceSampleRate) / processorSampleRate;
+    position = jlimit(0.0f, 1.0f, position);
 
-    MessageManager::callAsync([this, position]()
-    {
-        previewPlayheadPosition = jlimit(0.0f, 1.0f, position);
-        repaint();
-    });
+    if (position == previewPlayheadPosition)
+        return;
+
+    previewPlayheadPosition = position;
+    repaint();
 }
 
 void SamplePad::startPreviewPlayback()
@@ -1373,17 +1380,17 @@ void SamplePad::loadWaveform()
         auto* fileSource = new FileInputSource(audioFile);
         audioThumbnail.setSource(fileSource);
 
-        // Get sample rate of file source
-        {
-            juce::AudioFormatManager formatManager;
-            formatManager.registerBasicFormats();
+        // Get sample rate of file source: the store records it for finished
+        // downloads, anything else has its header read (nothing is decoded)
+        SampleStore::Entry entry;
 
-            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
-
-            if (reader != nullptr)
-            {
-                fileSourceSampleRate = reader->sampleRate;
-            }
+        if (freesoundId.isNotEmpty() && sampleStore->getEntry(freesoundId, entry) && entry.sampleRate > 0.0)
+        {
+            fileSourceSampleRate = (float)entry.sampleRate;
+        }
+        else if (std::unique_ptr<AudioFormatReader> reader { formatManager.createReaderFor(audioFile) })
+        {
+            fileSourceSampleRate = (float)reader->sampleRate;
         }
 
         fileSourceSampleRate = (fileSourceSampleRate <= 1.0) ? 44100.0 : fileSourceSampleRate;
@@ -1740,10 +1747,8 @@ File SamplePad::getWavFile() const
     if (!hasValidSample || freesoundId.isEmpty())
         return File();
 
-    File oggFile = audioFile;
-    File parentDir = oggFile.getParentDirectory();
-    String wavFileName = "FS_ID_" + freesoundId + ".wav";
-    return parentDir.getChildFile(wavFileName);
+    // Next to the .ogg, wherever the sample store put it
+    return audioFile.withFileExtension(".wav");
 }
 
 bool SamplePad::convertOggToWav(const File& oggFile, const File& wavFile)
@@ -1860,13 +1865,15 @@ SampleGridComponent::~SampleGridComponent()
 {
     stopTimer();
 
-    // Clean up any active downloads
-    cleanupSingleDownload();
+    // Their continuations capture this
+    masterSearch.cancel();
 
-    if (processor)
-    {
-        processor->removePlaybackListener(this);
-    }
+    for (auto& search : padSearches)
+        search.cancel();
+
+    // Clean up any active downloads
+    for (int i = 0; i < TOTAL_PADS; ++i)
+        cleanupSingleDownload(i);
 }
 
 void SampleGridComponent::paint(Graphics& g)
@@ -1958,18 +1965,8 @@ void SampleGridComponent::resized()
 
 void SampleGridComponent::setProcessor(FreesoundAdvancedSamplerAudioProcessor* p)
 {
-    if (processor)
-    {
-        processor->removePlaybackListener(this);
-    }
-
     processor = p;
 
-    if (processor)
-    {
-        processor->addPlaybackListener(this);
-    }
-
     // Set processor for all pads
     for (auto& pad : samplePads)
     {
@@ -2042,8 +2039,9 @@ void SampleGridComponent::loadSamplesFromJson(const File& metadataFile)
         DBG("TAGS ARE : " + fsTags);
         if (fileName.isNotEmpty())
         {
-            File audioFile = downloadDir.getChildFile(fileName);
-            if (audioFile.existsAsFile())
+            File audioFile = freesoundId.isNotEmpty() ? SampleStore::getSampleFile(downloadDir, freesoundId)
+                                                      : downloadDir.getChildFile(fileName);
+            if (freesoundId.isNotEmpty() ? hasSampleFile(downloadDir, freesoundId) : audioFile.existsAsFile())
             {
                 samplePads[i]->setSample(audioFile, sampleName, authorName, freesoundId, license, search_query, fsTags, fsDescription);
             }
@@ -2076,14 +2074,13 @@ void SampleGridComponent::loadSamplesFromArrays(const Array<FSSound>& sounds, co
         String fsTags = (i < soundInfo.size() && soundInfo[i].size() > 4) ? soundInfo[i][4] : ""; // Get tags from 5th element
         String fsDescription = (i < soundInfo.size() && soundInfo[i].size() > 5) ? soundInfo[i][5] : ""; // Get description from 6th element
 
-        String expectedFilename = "FS_ID_" + freesoundId + ".ogg";
-        File audioFile = downloadDir.getChildFile(expectedFilename);
+        File audioFile = SampleStore::getSampleFile(downloadDir, freesoundId);
 
         // DBG("Pad " + String(i) + ": " + sampleName + " (ID: " + freesoundId + ") with query: '" + sampleQuery + "'");
         // DBG("  Looking for file: " + audioFile.getFullPathName());
         // DBG("  File exists: " + String(audioFile.existsAsFile() ? "YES" : "NO"));
 
-        if (audioFile.existsAsFile())
+        if (hasSampleFile(downloadDir, freesoundId))
         {
             // IMPORTANT: Pass the query to setSample so it appears in the text box
             samplePads[i]->setSample(audioFile, sampleName, authorName, freesoundId, license, sampleQuery, fsTags, fsDescription);
@@ -2397,37 +2394,17 @@ void SampleGridComponent::updateJsonMetadata()
     metadataFile.replaceWithText(newJsonString);
 }
 
-void SampleGridComponent::noteStarted(int noteNumber, float velocity)
-{
-    // Convert MIDI note back to pad index
-    int padIndex = noteNumber - 36; // Note 36 = pad 0, Note 37 = pad 1, etc.
-    if (padIndex >= 0 && padIndex < TOTAL_PADS)
-    {
-        // These methods now handle message thread dispatching internally
-        samplePads[padIndex]->setIsPlaying(true);
-        samplePads[padIndex]->setPlayheadPosition(0.0f);
-    }
-}
-
-void SampleGridComponent::noteStopped(int noteNumber)
+void SampleGridComponent::updatePlaybackState(const PlaybackStateBoard& playbackState)
 {
-    // Convert MIDI note back to pad index
-    int padIndex = noteNumber - 36;
-    if (padIndex >= 0 && padIndex < TOTAL_PADS)
+    for (int padIndex = 0; padIndex < TOTAL_PADS; ++padIndex)
     {
-        // This method now handles message thread dispatching internally
-        samplePads[padIndex]->setIsPlaying(false);
-    }
-}
+        // Pad index = MIDI note - 36, same as the board's slots
+        const auto state = playbackState.getState(padIndex);
+        const bool retriggered = state.startCount != lastPadStartCounts[(size_t)padIndex];
+        lastPadStartCounts[(size_t)padIndex] = state.startCount;
 
-void SampleGridComponent::playheadPositionChanged(int noteNumber, float position)
-{
-    // Convert MIDI note back to pad index
-    int padIndex = noteNumber - 36;
-    if (padIndex >= 0 && padIndex < TOTAL_PADS)
-    {
-        // This method now handles message thread dispatching internally
-        samplePads[padIndex]->setPlayheadPosition(position);
+        samplePads[padIndex]->setIsPlaying(state.isPlaying || retriggered);
+        samplePads[padIndex]->setPlayheadPosition(state.isPlaying ? state.position : 0.0f);
     }
 }
 
@@ -2449,12 +2426,6 @@ Array<SamplePad::SampleInfo> SampleGridComponent::getAllSampleInfo() const
     return allSamples;
 }
 
-Array<FSSound> SampleGridComponent::searchSingleSound(const String& query)
-{
-    auto [finalSounds, soundInfo] = makeQuerySearchUsingFreesoundAPI(query, 1, true);
-    return finalSounds;
-}
-
 void SampleGridComponent::loadSingleSample(int padIndex, const FSSound& sound, const File& audioFile)
 {
     // Update the pad visually
@@ -2476,24 +2447,7 @@ void SampleGridComponent::loadSingleSample(int padIndex, const FSSound& sound, c
 
 void SampleGridComponent::downloadSingleSample(int padIndex, const FSSound& sound)
 {
-    // Create a download manager for single file
-    singlePadDownloadManager = std::make_unique<AudioDownloadManager>();
-    currentDownloadPadIndex = padIndex;
-    currentDownloadSound = sound;
-
-    // Use a simple callback approach instead of inheritance
-    // We'll check for completion in a timer or use the processor's download system
-
-    // Start download
-    Array<FSSound> singleSoundArray;
-    singleSoundArray.add(sound);
-
-    File samplesFolder = processor->getCurrentDownloadLocation();
-
-    // Use a timer to check for completion
-    startTimer(500); // Check every 500ms
-    singlePadDownloadManager->startDownloads(singleSoundArray, samplesFolder, processor->getQuery());
-
+    downloadSingleSampleWithQuery(padIndex, sound, processor->getQuery());
 }
 
 void SampleGridComponent::updateSinglePadInProcessor(int padIndex, const FSSound& sound)
@@ -2597,13 +2551,11 @@ void SampleGridComponent::populatePadsFromMasterSearch()
 
         const FSSound& sound = pendingMasterSearchSounds[soundIndex];
 
-        // Create filename using ID-based naming scheme
-        String expectedFilename = "FS_ID_" + sound.id + ".ogg";
-        File audioFile = downloadDir.getChildFile(expectedFilename);
+        File audioFile = SampleStore::getSampleFile(downloadDir, sound.id);
 
         // DBG("Looking for file: " + audioFile.getFullPathName() + " (exists: " + String(audioFile.existsAsFile() ? "YES" : "NO") + ")");
 
-        if (audioFile.existsAsFile())
+        if (hasSampleFile(downloadDir, sound.id))
         {
             // Get sample info
             String sampleName = (soundIndex < pendingMasterSearchSoundInfo.size() && pendingMasterSearchSoundInfo[soundIndex].size() > 0) ?
@@ -2716,7 +2668,7 @@ void SampleGridComponent::searchForSinglePadWithQuery(int padIndex, const String
     }
 
     // Check if this pad is already downloading
-    if (currentDownloadPadIndex == padIndex && singlePadDownloadManager && singlePadDownloadManager->isThreadRunning())
+    if (downloadScheduler->isRequestActive(padDownloads[padIndex].request))
     {
         AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon,
             "Download In Progress",
@@ -2754,9 +2706,18 @@ void SampleGridComponent::searchForSinglePadWithQuery(int padIndex, const String
 
 void SampleGridComponent::performSinglePadSearch(int padIndex, const String& query)
 {
-    // Search for a single sound with the specific query
-    Array<FSSound> searchResults = searchSingleSound(query);
+    // Search for a single sound with the specific query, off the message thread
+    padSearches[padIndex].cancel();
+    padSearches[padIndex] = makeQuerySearchUsingFreesoundAPIAsync(query, 1, true);
+
+    padSearches[padIndex].then([this, padIndex, query](const QuerySearchResult& result)
+    {
+        handleSinglePadSearchResult(padIndex, query, result.first);
+    });
+}
 
+void SampleGridComponent::handleSinglePadSearchResult(int padIndex, const String& query, const Array<FSSound>& searchResults)
+{
     if (searchResults.isEmpty())
     {
         AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon,
@@ -2770,13 +2731,11 @@ void SampleGridComponent::performSinglePadSearch(int padIndex, const String& que
     // Get the first (random) result
     FSSound newSound = searchResults[0];
 
-    // Create the filename
-    String fileName = "FS_ID_" + newSound.id + ".ogg";
     File samplesFolder = processor->getCurrentDownloadLocation();
-    File audioFile = samplesFolder.getChildFile(fileName);
+    File audioFile = SampleStore::getSampleFile(samplesFolder, newSound.id);
 
     // Check if we already have this sample downloaded
-    if (audioFile.existsAsFile())
+    if (hasSampleFile(samplesFolder, newSound.id))
     {
         // Use existing file
         loadSingleSampleWithQuery(padIndex, newSound, audioFile, query);
@@ -2809,28 +2768,19 @@ void SampleGridComponent::loadSingleSampleWithQuery(int padIndex, const FSSound&
 
 void SampleGridComponent::downloadSingleSampleWithQuery(int padIndex, const FSSound& sound, const String& query)
 {
-    // Store the query for later use
-    currentDownloadQuery = query;
-
-    // Clean up any existing download manager first
-    if (singlePadDownloadManager)
-    {
-        singlePadDownloadManager->stopThread(1000);
-        singlePadDownloadManager.reset();
-    }
+    if (padIndex < 0 || padIndex >= TOTAL_PADS)
+        return;
 
-    // Create a download manager for single file
-    singlePadDownloadManager = std::make_unique<AudioDownloadManager>();
-    // DON'T add listener to avoid double-listening conflicts
+    // Replaces an earlier download for this pad only; other pads and the master
+    // search keep going
+    cleanupSingleDownload(padIndex);
 
-    currentDownloadPadIndex = padIndex;
-    currentDownloadSound = sound;
+    auto& download = padDownloads[padIndex];
+    download.sound = sound;
+    download.query = query;
 
     // Start progress display on the pad
-    if (padIndex >= 0 && padIndex < TOTAL_PADS)
-    {
-        samplePads[padIndex]->startDownloadProgress();
-    }
+    samplePads[padIndex]->startDownloadProgress();
 
     // Start download
     Array<FSSound> singleSoundArray;
@@ -2838,97 +2788,118 @@ void SampleGridComponent::downloadSingleSampleWithQuery(int padIndex, const FSSo
 
     File samplesFolder = processor->getCurrentDownloadLocation();
 
-    // Use timer-based checking instead of listener to avoid conflicts
-    startTimer(250); // Check every 250ms
+    // Someone is waiting on this one, so it goes ahead of fills and backfill
+    download.request = downloadScheduler->addRequest(singleSoundArray, samplesFolder, this,
+                                                     DownloadScheduler::Priority::Interactive);
+}
+
+void SampleGridComponent::boostPadDownload(int padIndex)
+{
+    const auto soundId = getPendingSoundIdForPad(padIndex);
 
-    singlePadDownloadManager->startDownloads(singleSoundArray, samplesFolder, query);
+    if (soundId.isNotEmpty())
+        downloadScheduler->boostSound(soundId);
 }
 
-void SampleGridComponent::cleanupSingleDownload()
+void SampleGridComponent::setHoveredPad(int padIndex)
 {
-    // Clean up download manager safely
-    if (singlePadDownloadManager)
-    {
-        // Stop thread with timeout
-        if (singlePadDownloadManager->isThreadRunning())
-        {
-            singlePadDownloadManager->stopThread(2000);
-        }
-        singlePadDownloadManager.reset();
-    }
+    downloadScheduler->setHoveredSound(getPendingSoundIdForPad(padIndex));
+}
+
+bool SampleGridComponent::hasSampleFile(const File& folder, const String& freesoundId) const
+{
+    // The store answers for its own folder from the index; anywhere else is
+    // checked on disk
+    if (folder == sampleStore->getFolder())
+        return sampleStore->contains(freesoundId);
 
-    currentDownloadPadIndex = -1;
-    currentDownloadQuery = "";
+    return SampleStore::getSampleFile(folder, freesoundId).existsAsFile();
 }
 
-void SampleGridComponent::timerCallback()
+String SampleGridComponent::getPendingSoundIdForPad(int padIndex) const
+{
+    if (padIndex < 0 || padIndex >= TOTAL_PADS || padDownloads[padIndex].request != 0)
+        return {}; // Single pad downloads are already at the front
+
+    // Pads filled by the master search get their sounds in pad order
+    const int soundIndex = pendingMasterSearchPads.indexOf(padIndex);
+
+    if (soundIndex >= 0 && soundIndex < pendingMasterSearchSounds.size())
+        return pendingMasterSearchSounds.getReference(soundIndex).id;
+
+    return {};
+}
+
+void SampleGridComponent::cleanupSingleDownload(int padIndex)
 {
-    // Check if we're handling single pad downloads
-    if (singlePadDownloadManager && currentDownloadPadIndex >= 0)
+    auto& download = padDownloads[padIndex];
+
+    if (download.request != 0)
+        downloadScheduler->cancelRequest(download.request);
+
+    download = PadDownload();
+}
+
+void SampleGridComponent::downloadRequestProgress(DownloadScheduler::RequestID requestId,
+                                                  const Array<DownloadScheduler::FileState>& files)
+{
+    for (int padIndex = 0; padIndex < TOTAL_PADS; ++padIndex)
     {
-        String fileName = "FS_ID_" + currentDownloadSound.id + ".ogg";
-        File samplesFolder = processor->getCurrentDownloadLocation();
-        File audioFile = samplesFolder.getChildFile(fileName);
+        if (padDownloads[padIndex].request != requestId || files.isEmpty())
+            continue;
 
-        // Check if download is still running
-        bool downloadRunning = singlePadDownloadManager->isThreadRunning();
+        const auto& file = files.getReference(0);
 
-        if (audioFile.existsAsFile())
-        {
-            // Download completed successfully
-            stopTimer();
+        if (file.total > 0)
+            samplePads[padIndex]->updateDownloadProgress((double)file.downloaded / (double)file.total);
 
-            // Load the sample
-            loadSingleSampleWithQuery(currentDownloadPadIndex, currentDownloadSound, audioFile, currentDownloadQuery);
+        return;
+    }
+}
 
-            // Finish progress with success - use SafePointer
-            if (currentDownloadPadIndex < TOTAL_PADS && samplePads[currentDownloadPadIndex])
-            {
-                samplePads[currentDownloadPadIndex]->finishDownloadProgress(true, "Complete!");
-            }
+void SampleGridComponent::downloadRequestFinished(DownloadScheduler::RequestID requestId, bool success)
+{
+    for (int padIndex = 0; padIndex < TOTAL_PADS; ++padIndex)
+    {
+        auto& download = padDownloads[padIndex];
 
-            // Clean up safely
-            cleanupSingleDownload();
-        }
-        else if (!downloadRunning)
-        {
-            // Download thread finished but no file - failed
-            stopTimer();
+        if (download.request != requestId)
+            continue;
 
-            // Finish progress with error - use SafePointer
-            if (currentDownloadPadIndex < TOTAL_PADS && samplePads[currentDownloadPadIndex])
-            {
-                samplePads[currentDownloadPadIndex]->finishDownloadProgress(false, "Download failed!");
-            }
+        const auto sound = download.sound;
+        const auto query = download.query;
+        download = PadDownload();
+
+        File audioFile = DownloadScheduler::getFileForSound(sound.id, processor->getCurrentDownloadLocation());
 
-            // Clean up safely
-            cleanupSingleDownload();
+        if (success && audioFile.existsAsFile())
+        {
+            // Load the sample
+            loadSingleSampleWithQuery(padIndex, sound, audioFile, query);
+            samplePads[padIndex]->finishDownloadProgress(true, "Complete!");
         }
         else
         {
-            // Still downloading - update progress if possible
-            // Simple progress estimation based on time (fallback)
-            if (currentDownloadPadIndex < TOTAL_PADS && samplePads[currentDownloadPadIndex])
-            {
-                // You could implement a simple time-based progress here if needed
-                // For now, just ensure the progress bar is still showing
-            }
+            samplePads[padIndex]->finishDownloadProgress(false, "Download failed!");
         }
+
+        return;
     }
-    else
-    {
-        // This is the delayed repaint from loadSamplesFromArrays
-        stopTimer();
+}
+
+void SampleGridComponent::timerCallback()
+{
+    // This is the delayed repaint from loadSamplesFromArrays
+    stopTimer();
 
-        // Safely repaint all pads
-        for (auto& pad : samplePads)
+    // Safely repaint all pads
+    for (auto& pad : samplePads)
+    {
+        if (pad && pad->isShowing() &&
+            pad->getLocalBounds().getWidth() > 0 &&
+            pad->getLocalBounds().getHeight() > 0)
         {
-            if (pad && pad->isShowing() &&
-                pad->getLocalBounds().getWidth() > 0 &&
-                pad->getLocalBounds().getHeight() > 0)
-            {
-                pad->repaint();
-            }
+            pad->repaint();
         }
     }
 }
@@ -3251,14 +3222,17 @@ void SampleGridComponent::performEnhancedDrop(const String& jsonMetadata, const
 
     // Determine target file location
     File samplesDir = processor->getCurrentDownloadLocation();
-    String targetFileName = "FS_ID_" + freesoundId + ".ogg";
-    File targetFile = samplesDir.getChildFile(targetFileName);
+    File targetFile = SampleStore::getSampleFile(samplesDir, freesoundId);
 
     // Copy file if it doesn't exist
     if (!targetFile.existsAsFile())
     {
-        if (!sourceFile.copyFileTo(targetFile))
+        if (!targetFile.getParentDirectory().createDirectory() || !sourceFile.copyFileTo(targetFile))
             return;
+
+        // Index it like a download, so presence checks find it
+        if (samplesDir == processor->getPresetManager().getSamplesFolder())
+            processor->getPresetManager().getSampleStore().addCompletedFile(freesoundId, targetFile);
     }
 
     // Create FSSound object for processor
@@ -3422,7 +3396,21 @@ void SampleGridComponent::executeMasterSearch(const String& masterQuery, const A
 
     int numSoundsNeeded = targetPadIndices.size();
 
-    auto [finalSounds, soundInfo] = makeQuerySearchUsingFreesoundAPI(masterQuery, numSoundsNeeded, true);
+    masterSearch.cancel();
+    masterSearch = makeQuerySearchUsingFreesoundAPIAsync(masterQuery, numSoundsNeeded, true);
+
+    masterSearch.then([this, masterQuery, targetPadIndices](const QuerySearchResult& result)
+    {
+        handleMasterSearchResult(masterQuery, targetPadIndices, result);
+    });
+}
+
+void SampleGridComponent::handleMasterSearchResult(const String& masterQuery, const Array<int>& targetPadIndices, const QuerySearchResult& result)
+{
+    if (!processor)
+        return;
+
+    const auto& [finalSounds, soundInfo] = result;
 
     if (finalSounds.isEmpty())
     {
@@ -3439,7 +3427,7 @@ void SampleGridComponent::executeMasterSearch(const String& masterQuery, const A
     }
 
     // Calculate how many sounds we need
-    processor->newSoundsReady(finalSounds, masterQuery, soundInfo);
+    processor->newSoundsReady(finalSounds, masterQuery, soundInfo, targetPadIndices);
     std::cout << "Sound 0 tags : " << finalSounds[0].tags.joinIntoString(",")  << std::endl;
 }
 
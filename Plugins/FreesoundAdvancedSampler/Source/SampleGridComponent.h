@@ -82,6 +82,14 @@ struct Badge {
     bool usesSvg() const { return svgDrawable != nullptr; }
 };
 
+//==============================================================================
+// One thumbnail cache for every pad in the process, so a sound that sits on
+// several pads (or in several plugin instances) is only scanned once
+struct SharedThumbnailCache : public AudioThumbnailCache
+{
+    SharedThumbnailCache() : AudioThumbnailCache(64) {}
+};
+
 //==============================================================================
 // SamplePad Component (unified implementation with preview mode)
 class SamplePad : public Component,
@@ -203,7 +211,8 @@ protected:
     int padIndex;
 
     AudioFormatManager formatManager;
-    AudioThumbnailCache audioThumbnailCache;
+    SharedResourcePointer<SharedThumbnailCache> audioThumbnailCache;
+    SharedResourcePointer<SampleStore> sampleStore;
     std::unique_ptr<AudioFormatReader> audioReader;
     AudioThumbnail audioThumbnail;
 
@@ -216,7 +225,6 @@ protected:
     String tags;
     String description;
     float fileSourceSampleRate = 44100.0f;
-    float processorSampleRate = 44100.0f;
     String getKeyboardKeyForPad(int padIndex) const;
 
     // Playback state
@@ -264,11 +272,11 @@ private:
 // SampleGridComponent (the grid of sample pads)
 //==============================================================================
 class SampleGridComponent : public Component,
-                            public FreesoundAdvancedSamplerAudioProcessor::PlaybackListener,
                             public DragAndDropContainer,
                             public DragAndDropTarget,      // for drag and drop between pads or different instances of same VST
                             public FileDragAndDropTarget,  // Add for external files between different targets or compatible apps
-                            public Timer
+                            public Timer,
+                            private DownloadScheduler::Listener
 {
 public:
     SampleGridComponent();
@@ -292,6 +300,12 @@ public:
         const std::vector<StringArray>& soundInfo, const String& masterQuery);
     void searchForSinglePadWithQuery(int padIndex, const String& query);
 
+    // Moves the sound a pad is waiting for to the front of the download queue
+    void boostPadDownload(int padIndex);
+
+    // Same, but only while the mouse is over the pad; -1 when it leaves
+    void setHoveredPad(int padIndex);
+
     // Master search integration
     void setPositionConnectedToMaster(int row, int col, bool connected);
     bool isPositionConnectedToMaster(int row, int col) const;
@@ -299,10 +313,8 @@ public:
     void searchSelectedPositions(const String& masterQuery);
     void performSinglePadSearch(int padIndex, const String& query);
 
-    // PlaybackListener implementation
-    void noteStarted(int noteNumber, float velocity) override;
-    void noteStopped(int noteNumber) override;
-    void playheadPositionChanged(int noteNumber, float position) override;
+    // Called by the editor once per frame with the processor's playback state
+    void updatePlaybackState(const PlaybackStateBoard& playbackState);
 
     void updateJsonMetadata();
 
@@ -338,15 +350,34 @@ private:
 
     FreesoundAdvancedSamplerAudioProcessor* processor;
 
+    // Last start count seen per pad, so hits shorter than a frame still flash
+    std::array<uint32, TOTAL_PADS> lastPadStartCounts {};
+
     // Master search system (position-based, not pad-index based)
     std::array<bool, TOTAL_PADS> masterSearchConnections; // tracks visual positions (0-15)
     MasterSearchPanel masterSearchPanel;
 
-    // Single pad download management (simplified)
-    std::unique_ptr<AudioDownloadManager> singlePadDownloadManager;
-    int currentDownloadPadIndex = -1;
-    FSSound currentDownloadSound;
-    String currentDownloadQuery;
+    // Single pad downloads, one per pad, through the shared download scheduler
+    struct PadDownload
+    {
+        DownloadScheduler::RequestID request = 0;
+        FSSound sound;
+        String query;
+    };
+
+    SharedResourcePointer<DownloadScheduler> downloadScheduler;
+    SharedResourcePointer<SampleStore> sampleStore;
+    std::array<PadDownload, TOTAL_PADS> padDownloads;
+
+    // The master search sound a pad is still waiting for, or empty
+    String getPendingSoundIdForPad(int padIndex) const;
+
+    bool hasSampleFile(const File& folder, const String& freesoundId) const;
+
+    // Searches run on the Freesound request pool; a new search for the same
+    // pads cancels the one still in flight
+    std::array<FSFuture<QuerySearchResult>, TOTAL_PADS> padSearches;
+    FSFuture<QuerySearchResult> masterSearch;
 
     // Helper methods
     void loadSamplesFromJson(const File& metadataFile);
@@ -356,11 +387,16 @@ private:
         const FSSound& sound, const File& audioFile, const String& query);
     void downloadSingleSampleWithQuery(int padIndex, const FSSound& sound, const String& query);
     void updateProcessorArraysFromGrid();
-    Array<FSSound> searchSingleSound(const String& query);
+    void handleSinglePadSearchResult(int padIndex, const String& query, const Array<FSSound>& searchResults);
     void loadSingleSample(int padIndex, const FSSound& sound, const File& audioFile);
     void downloadSingleSample(int padIndex, const FSSound& sound);
     void updateSinglePadInProcessor(int padIndex, const FSSound& sound);
-    void cleanupSingleDownload();  // Add cleanup method
+    void cleanupSingleDownload(int padIndex);
+
+    // DownloadScheduler::Listener
+    void downloadRequestProgress(DownloadScheduler::RequestID requestId,
+                                 const Array<DownloadScheduler::FileState>& files) override;
+    void downloadRequestFinished(DownloadScheduler::RequestID requestId, bool success) override;
 
     // Position conversion helpers
     int getVisualPositionFromRowCol(int row, int col) const;
@@ -389,6 +425,7 @@ private:
     void updateProcessorArraysForMasterSearch(const Array<FSSound>& sounds,
     const std::vector<StringArray>& soundInfo, const Array<int>& targetPads, const String& masterQuery);
     void executeMasterSearch(const String& masterQuery, const Array<int>& targetPadIndices);
+    void handleMasterSearchResult(const String& masterQuery, const Array<int>& targetPadIndices, const QuerySearchResult& result);
 
     Array<int> pendingMasterSearchPads;
     String pendingMasterSearchQuery;
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    SampleKit.cpp
+    Created: Immutable decoded pad set shared between the kit builder and
+             the audio thread
+
+  ==============================================================================
+*/
+
+#include "SampleKit.h"
+#include "PadVoiceKernel.h"
+
+PadSample::PadSample(const String& freesoundId, AudioBuffer<float>&& head, int headLength,
+                     int64 totalLengthInSamples, double sampleRate, const File& sourceFile,
+                     Storage storageToUse)
+    : freesoundId(freesoundId),
+      numericId(freesoundId.getLargeIntValue()),
+      storage(storageToUse),
+      numChannels(head.getNumChannels()),
+      numStoredFrames(head.getNumSamples()),
+      audioData(storageToUse == Storage::Float32 ? std::move(head) : AudioBuffer<float>()),
+      headLength(headLength),
+      length(totalLengthInSamples),
+      sourceSampleRate(sampleRate),
+      sourceFile(sourceFile)
+{
+    if (storage == Storage::Float32)
+        return;
+
+    // head wasn't moved from, convert it and let it go
+    compactData.malloc((size_t)numChannels * (size_t)numStoredFrames);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* dest = compactData.get() + (size_t)channel * (size_t)numStoredFrames;
+
+        if (storage == Storage::Int16)
+            PadVoiceKernel::floatToInt16(head.getReadPointer(channel), reinterpret_cast<int16*>(dest), numStoredFrames);
+        else
+            PadVoiceKernel::floatToHalf(head.getReadPointer(channel), dest, numStoredFrames);
+    }
+}
+
+const float* PadSample::getFloatData(int channel) const
+{
+    return storage == Storage::Float32 ? audioData.getReadPointer(channel) : nullptr;
+}
+
+void PadSample::readFrames(int channel, int startFrame, float* dest, int numFrames) const
+{
+    jassert(startFrame >= 0 && startFrame + numFrames <= numStoredFrames);
+
+    if (storage == Storage::Float32)
+    {
+        FloatVectorOperations::copy(dest, audioData.getReadPointer(channel, startFrame), numFrames);
+        return;
+    }
+
+    const uint16* src = compactData.get() + (size_t)channel * (size_t)numStoredFrames + (size_t)startFrame;
+
+    if (storage == Storage::Int16)
+        PadVoiceKernel::int16ToFloat(reinterpret_cast<const int16*>(src), dest, numFrames);
+    else
+        PadVoiceKernel::halfToFloat(src, dest, numFrames);
+}
+
+AudioBuffer<float> PadSample::getHeadAsFloat() const
+{
+    AudioBuffer<float> head(numChannels, numStoredFrames);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        readFrames(channel, 0, head.getWritePointer(channel), numStoredFrames);
+
+    return head;
+}
+
+size_t PadSample::getSizeInBytes() const
+{
+    const size_t bytesPerSample = storage == Storage::Float32 ? sizeof(float) : sizeof(uint16);
+    return (size_t)numChannels * (size_t)numStoredFrames * bytesPerSample;
+}
+
+//==============================================================================
+
+SampleKitExchange::SampleKitExchange()
+{
+    // Retries blocked hand-offs and frees kits nobody renders with anymore
+    startTimer(100);
+}
+
+SampleKitExchange::~SampleKitExchange()
+{
+    stopTimer();
+}
+
+void SampleKitExchange::publish(SampleKit::Ptr newKit)
+{
+    if (newKit == nullptr)
+        return;
+
+    const ScopedLock sl(lock);
+
+    retainedKits.add(newKit);
+    queuedKit = newKit; // replaces any older kit still waiting for the mailbox
+    handOffQueuedKit();
+}
+
+SampleKit* SampleKitExchange::acquireForAudioThread()
+{
+    if (auto* incoming = mailbox.load(std::memory_order_acquire))
+    {
+        // The kit stays in the mailbox until we hold our own reference and have
+        // advertised it as in use, so the reclaimer can never free it in between
+        audioThreadKit = incoming;
+        kitInUse.store(incoming, std::memory_order_release);
+        mailbox.store(nullptr, std::memory_order_release);
+    }
+
+    return audioThreadKit.get();
+}
+
+void SampleKitExchange::timerCallback()
+{
+    const ScopedLock sl(lock);
+
+    handOffQueuedKit();
+    reclaimUnusedKits();
+}
+
+void SampleKitExchange::handOffQueuedKit()
+{
+    if (queuedKit == nullptr)
+        return;
+
+    // Only fill an empty mailbox: the audio thread may be reading the current one
+    SampleKit* expected = nullptr;
+    if (mailbox.compare_exchange_strong(expected, queuedKit.get(), std::memory_order_acq_rel))
+        queuedKit = nullptr;
+}
+
+void SampleKitExchange::reclaimUnusedKits()
+{
+    auto* inMailbox = mailbox.load(std::memory_order_acquire);
+    auto* inUse = kitInUse.load(std::memory_order_acquire);
+
+    for (int i = retainedKits.size(); --i >= 0;)
+    {
+        auto* kit = retainedKits.getUnchecked(i);
+
+        if (kit == inMailbox || kit == inUse || kit == queuedKit.get())
+            continue;
+
+        // Only our own reference left: no voice is still playing from it
+        if (kit->getReferenceCount() == 1)
+            retainedKits.remove(i);
+    }
+}
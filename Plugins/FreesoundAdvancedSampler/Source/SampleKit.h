@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    SampleKit.h
+    Created: Immutable decoded pad set shared between the kit builder and
+             the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+//==============================================================================
+// Decoded audio for one pad. Never modified after construction.
+//
+// Only the first getHeadLength() frames live in memory. Longer files are
+// streamed from getSourceFile() past that point (see PadStream).
+//
+// The head can be kept as 16-bit values instead of floats, which halves its
+// size. Voices then convert the frames they need while rendering (readFrames).
+//==============================================================================
+class PadSample : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<PadSample>;
+
+    enum class Storage
+    {
+        Float32,
+        Int16,      // Plenty for the 16-bit material Freesound serves
+        Float16     // Half floats, keeps the dynamic range of quiet sounds
+    };
+
+    // head must contain headLength frames followed by a few frames of zero
+    // padding, so interpolating voices can read one frame past the end
+    PadSample(const String& freesoundId, AudioBuffer<float>&& head, int headLength,
+              int64 totalLengthInSamples, double sampleRate, const File& sourceFile,
+              Storage storage = Storage::Float32);
+
+    const String& getFreesoundId() const { return freesoundId; }
+    int64 getNumericId() const { return numericId; } // for the audio thread, which can't copy Strings
+    Storage getStorage() const { return storage; }
+    int getNumChannels() const { return numChannels; }
+    int getHeadLength() const { return headLength; }
+    int64 getLengthInSamples() const { return length; }
+    double getSampleRate() const { return sourceSampleRate; }
+    const File& getSourceFile() const { return sourceFile; }
+
+    bool isStreamed() const { return length > headLength; }
+
+    // Head frames as floats, for Float32 storage only (nullptr otherwise)
+    const float* getFloatData(int channel) const;
+
+    // Copies head frames (padding included) into dest as floats, whatever the
+    // storage. Doesn't allocate, so the audio thread can use it.
+    void readFrames(int channel, int startFrame, float* dest, int numFrames) const;
+
+    // The whole head as floats. Allocates, don't call from the audio thread.
+    AudioBuffer<float> getHeadAsFloat() const;
+
+    size_t getSizeInBytes() const;
+
+    static constexpr int paddingSamples = 4;
+
+private:
+    const String freesoundId;
+    const int64 numericId;
+    const Storage storage;
+    const int numChannels;
+    const int numStoredFrames; // head plus padding
+    const AudioBuffer<float> audioData;
+    HeapBlock<uint16> compactData; // channels one after the other, Int16 or Float16 bits
+    const int headLength;
+    const int64 length;
+    const double sourceSampleRate;
+    const File sourceFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PadSample)
+};
+
+//==============================================================================
+// A full 4x4 pad set. Built off the audio thread, then published through
+// SampleKitExchange and treated as read-only from then on.
+//==============================================================================
+class SampleKit : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<SampleKit>;
+
+    static constexpr int numPads = 16;
+    static constexpr int firstMidiNote = 36; // Pad 0 = note 36 (C2)
+
+    SampleKit() = default;
+
+    void setPad(int padIndex, PadSample::Ptr sample)
+    {
+        if (isPositiveAndBelow(padIndex, numPads))
+            pads[(size_t)padIndex] = sample;
+    }
+
+    PadSample* getPad(int padIndex) const
+    {
+        return isPositiveAndBelow(padIndex, numPads) ? pads[(size_t)padIndex].get() : nullptr;
+    }
+
+    PadSample* getPadForNote(int midiNoteNumber) const { return getPad(midiNoteNumber - firstMidiNote); }
+
+    int getNumLoadedPads() const
+    {
+        int count = 0;
+        for (const auto& pad : pads)
+            if (pad != nullptr)
+                ++count;
+        return count;
+    }
+
+private:
+    std::array<PadSample::Ptr, numPads> pads;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleKit)
+};
+
+//==============================================================================
+// The one SynthesiserSound a kit-playing sampler holds. It only routes notes to
+// the voices; the audio itself comes from the kit the audio thread picked up
+// at the start of the block.
+//==============================================================================
+class KitSound : public SynthesiserSound
+{
+public:
+    KitSound(int lowestNote = SampleKit::firstMidiNote, int numNotes = SampleKit::numPads)
+        : lowestNote(lowestNote), numNotes(numNotes)
+    {
+    }
+
+    bool appliesToNote(int midiNoteNumber) override
+    {
+        return midiNoteNumber >= lowestNote && midiNoteNumber < lowestNote + numNotes;
+    }
+
+    bool appliesToChannel(int) override { return true; }
+
+    int getLowestNote() const { return lowestNote; }
+
+private:
+    const int lowestNote;
+    const int numNotes;
+};
+
+//==============================================================================
+// Hands kits to the audio thread with a single atomic pointer exchange and
+// frees old kits later on the message thread.
+//
+// Every published kit is retained here until it is neither in the mailbox, nor
+// the kit the audio thread renders with, nor referenced by a playing voice.
+// That guarantees reference counts never hit zero on the audio thread.
+//==============================================================================
+class SampleKitExchange : private Timer
+{
+public:
+    SampleKitExchange();
+    ~SampleKitExchange() override;
+
+    // Any thread except the audio thread. The newest kit always wins.
+    void publish(SampleKit::Ptr newKit);
+
+    // Audio thread only: installs a newly published kit, if any, and returns
+    // the kit to render this block with (may be nullptr)
+    SampleKit* acquireForAudioThread();
+
+private:
+    void timerCallback() override;
+    void handOffQueuedKit();
+    void reclaimUnusedKits();
+
+    CriticalSection lock; // never taken by the audio thread
+    SampleKit::Ptr queuedKit;
+    ReferenceCountedArray<SampleKit> retainedKits;
+
+    std::atomic<SampleKit*> mailbox { nullptr };
+    std::atomic<SampleKit*> kitInUse { nullptr };
+    SampleKit::Ptr audioThreadKit; // audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleKitExchange)
+};
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    SampleKitBuilder.cpp
+    Created: Decodes pad sets on a worker thread and publishes them as
+             immutable SampleKits
+
+  ==============================================================================
+*/
+
+#include "SampleKitBuilder.h"
+
+SampleKitBuilder::SampleKitBuilder(SampleKitExchange& destination)
+    : Thread("SampleKitBuilder"),
+      exchange(destination)
+{
+    startThread();
+}
+
+SampleKitBuilder::~SampleKitBuilder()
+{
+    stopThread(4000);
+}
+
+void SampleKitBuilder::requestBuild(const Array<PadSource>& pads)
+{
+    {
+        const ScopedLock sl(requestLock);
+        pendingPads = pads;
+        lastRequestedPads = pads;
+        pendingPadUpdates.clear();
+        hasPendingRequest = true;
+    }
+
+    notify();
+}
+
+void SampleKitBuilder::requestPadUpdate(const PadSource& pad)
+{
+    {
+        const ScopedLock sl(requestLock);
+
+        // Keep lastRequestedPads in step, so a later rebuild() includes this pad
+        for (int i = lastRequestedPads.size(); --i >= 0;)
+            if (lastRequestedPads.getReference(i).padIndex == pad.padIndex)
+                lastRequestedPads.remove(i);
+
+        lastRequestedPads.add(pad);
+        pendingPadUpdates.add(pad);
+    }
+
+    notify();
+}
+
+void SampleKitBuilder::setTargetSampleRate(double newSampleRate)
+{
+    {
+        const ScopedLock sl(requestLock);
+
+        if (newSampleRate == targetSampleRate)
+            return;
+
+        targetSampleRate = newSampleRate;
+
+        if (!resampleOnLoad)
+            return;
+
+        rebuildLastRequest();
+    }
+
+    notify();
+}
+
+void SampleKitBuilder::setResampleOnLoad(bool shouldResample)
+{
+    {
+        const ScopedLock sl(requestLock);
+
+        if (shouldResample == resampleOnLoad)
+            return;
+
+        resampleOnLoad = shouldResample;
+        rebuildLastRequest();
+    }
+
+    notify();
+}
+
+bool SampleKitBuilder::isResamplingOnLoad() const
+{
+    const ScopedLock sl(requestLock);
+    return resampleOnLoad;
+}
+
+void SampleKitBuilder::rebuild()
+{
+    {
+        const ScopedLock sl(requestLock);
+        rebuildLastRequest();
+    }
+
+    notify();
+}
+
+void SampleKitBuilder::rebuildLastRequest()
+{
+    // Caller holds requestLock. A request that is still pending is rebuilt anyway.
+    if (lastRequestedPads.isEmpty())
+        return;
+
+    pendingPads = lastRequestedPads;
+    hasPendingRequest = true;
+}
+
+bool SampleKitBuilder::hasNewerRequest()
+{
+    const ScopedLock sl(requestLock);
+    return hasPendingRequest;
+}
+
+bool SampleKitBuilder::takePendingRequest(Array<PadSource>& pads, double& sampleRate)
+{
+    const ScopedLock sl(requestLock);
+
+    if (!hasPendingRequest)
+        return false;
+
+    pads = pendingPads;
+
+    // Pad updates that came in after the build was requested go into it,
+    // replacing whatever the request had for those pads
+    for (const auto& update : pendingPadUpdates)
+    {
+        for (int i = pads.size(); --i >= 0;)
+            if (pads.getReference(i).padIndex == update.padIndex)
+                pads.remove(i);
+
+        pads.add(update);
+    }
+
+    sampleRate = resampleOnLoad ? targetSampleRate : 0.0;
+    hasPendingRequest = false;
+    pendingPadUpdates.clear();
+    return true;
+}
+
+bool SampleKitBuilder::takePendingPadUpdate(PadSource& pad, double& sampleRate)
+{
+    const ScopedLock sl(requestLock);
+
+    if (hasPendingRequest || pendingPadUpdates.isEmpty())
+        return false;
+
+    pad = pendingPadUpdates.removeAndReturn(0);
+    sampleRate = resampleOnLoad ? targetSampleRate : 0.0;
+    return true;
+}
+
+void SampleKitBuilder::run()
+{
+    while (!threadShouldExit())
+    {
+        Array<PadSource> pads;
+        PadSource pad;
+        double sampleRate = 0.0;
+
+        if (takePendingRequest(pads, sampleRate))
+        {
+            auto kit = buildKit(pads, sampleRate);
+
+            // Drop the result if a newer kit was requested while decoding
+            if (kit != nullptr && !threadShouldExit() && !hasNewerRequest())
+            {
+                exchange.publish(kit);
+                lastPublishedKit = kit;
+            }
+        }
+        else if (takePendingPadUpdate(pad, sampleRate))
+        {
+            installPad(pad, sampleRate);
+        }
+        else
+        {
+            wait(-1);
+        }
+    }
+}
+
+void SampleKitBuilder::installPad(const PadSource& pad, double sampleRate)
+{
+    auto sample = samplePool->getSample(pad.freesoundId, pad.audioFile, sampleRate);
+
+    if (sample == nullptr || threadShouldExit() || hasNewerRequest())
+        return;
+
+    // Kits are immutable once published, so this is a copy with one pad replaced
+    SampleKit::Ptr kit = new SampleKit();
+
+    if (lastPublishedKit != nullptr)
+        for (int i = 0; i < SampleKit::numPads; ++i)
+            kit->setPad(i, lastPublishedKit->getPad(i));
+
+    kit->setPad(pad.padIndex, sample);
+
+    exchange.publish(kit);
+    lastPublishedKit = kit;
+}
+
+SampleKit::Ptr SampleKitBuilder::buildKit(const Array<PadSource>& pads, double sampleRate)
+{
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    // One decode job per pad on the pool's decode threads. Pads sharing a
+    // sound share one decoded buffer.
+    Array<DecodedSamplePool::SampleRequest> requests;
+
+    for (const auto& pad : pads)
+        requests.add({ pad.freesoundId, pad.audioFile });
+
+    auto samples = samplePool->getSamples(requests, sampleRate, [this] { return threadShouldExit() || hasNewerRequest(); });
+
+    if (threadShouldExit() || hasNewerRequest())
+        return nullptr;
+
+    SampleKit::Ptr kit = new SampleKit();
+
+    for (int i = 0; i < pads.size(); ++i)
+        if (auto sample = samples[i])
+            kit->setPad(pads.getReference(i).padIndex, sample);
+
+    lastBuildSeconds.store(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks));
+
+    DBG("Built kit of " << kit->getNumLoadedPads() << " pads in " << roundToInt(lastBuildSeconds.load() * 1000.0)
+        << " ms on up to " << samplePool->getDecodeConcurrency() << " threads");
+
+    return kit;
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    SampleKitBuilder.h
+    Created: Decodes pad sets on a worker thread and publishes them as
+             immutable SampleKits
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "SampleKit.h"
+#include "DecodedSamplePool.h"
+
+using namespace juce;
+
+class SampleKitBuilder : private Thread
+{
+public:
+    struct PadSource
+    {
+        int padIndex = -1;
+        String freesoundId;
+        File audioFile;
+    };
+
+    explicit SampleKitBuilder(SampleKitExchange& destination);
+    ~SampleKitBuilder() override;
+
+    // Safe to call from any thread, returns immediately. If a build is already
+    // running it is abandoned in favour of this request.
+    void requestBuild(const Array<PadSource>& pads);
+
+    // Decodes a single pad and publishes the last kit with just that pad
+    // swapped in, leaving the others as they are. Used to make pads playable
+    // one by one as their downloads land. A full requestBuild() supersedes any
+    // pad updates still waiting; updates made after it are built into it.
+    void requestPadUpdate(const PadSource& pad);
+
+    // Short pads are resampled to this rate while the kit is built. A change
+    // rebuilds the last requested kit in the background.
+    void setTargetSampleRate(double newSampleRate);
+
+    // Off: pads keep their file's rate and the voices interpolate at play time
+    void setResampleOnLoad(bool shouldResample);
+    bool isResamplingOnLoad() const;
+
+    // Builds the last requested kit again, e.g. after pool settings changed
+    void rebuild();
+
+    // Wall-clock time the last full kit build took, pool hits included
+    double getLastBuildSeconds() const { return lastBuildSeconds.load(); }
+
+private:
+    void run() override;
+    SampleKit::Ptr buildKit(const Array<PadSource>& pads, double sampleRate);
+    bool hasNewerRequest();
+    bool takePendingRequest(Array<PadSource>& pads, double& sampleRate);
+    bool takePendingPadUpdate(PadSource& pad, double& sampleRate);
+    void installPad(const PadSource& pad, double sampleRate);
+    void rebuildLastRequest();
+
+    SampleKitExchange& exchange;
+    SharedResourcePointer<DecodedSamplePool> samplePool;
+
+    CriticalSection requestLock;
+    Array<PadSource> pendingPads, lastRequestedPads, pendingPadUpdates;
+    bool hasPendingRequest = false;
+    double targetSampleRate = 0.0;
+    bool resampleOnLoad = true;
+
+    SampleKit::Ptr lastPublishedKit; // builder thread only
+    std::atomic<double> lastBuildSeconds { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleKitBuilder)
+};
@@ -0,0 +1,596 @@
+/*
+  ==============================================================================
+
+    SampleStore.cpp
+    Created: Index of the downloaded samples folder, so presence checks and
+             integrity checks don't have to touch the files themselves
+
+  ==============================================================================
+*/
+
+#include "SampleStore.h"
+
+#include <unordered_set>
+
+namespace
+{
+    // Header: magic, version, record size, record count (all uint32), then
+    // from version 2 the quota (64 bit)
+    constexpr int headerSizeV1 = 16;
+    constexpr int headerSize = 24;
+
+    // Record: id, size, hash, sample rate (double bits), length, last access
+    // (all 64 bit), state, reserved (32 bit). Little-endian throughout.
+    constexpr int recordSize = 56;
+
+    // Folders whose top level may still hold files from before the subfolders.
+    // Empty once every migration is done, which lets getSampleFile() skip the
+    // lock and the filesystem.
+    CriticalSection migratingLock;
+    Array<File> migratingFolders;
+    std::atomic<int> numMigratingFolders { 0 };
+
+    bool isMigrating(const File& folder)
+    {
+        if (numMigratingFolders.load() == 0)
+            return false;
+
+        const ScopedLock sl(migratingLock);
+        return migratingFolders.contains(folder);
+    }
+
+    void setMigrating(const File& folder, bool migrating)
+    {
+        const ScopedLock sl(migratingLock);
+
+        if (migrating)
+            migratingFolders.addIfNotAlreadyThere(folder);
+        else
+            migratingFolders.removeFirstMatchingValue(folder);
+
+        numMigratingFolders = migratingFolders.size();
+    }
+}
+
+SampleStore::SampleStore()
+{
+    formatManager.registerBasicFormats();
+}
+
+SampleStore::~SampleStore()
+{
+    evictionThread.removeTimeSliceClient(this);
+    evictionThread.stopThread(5000);
+
+    stopTimer();
+    flush();
+}
+
+void SampleStore::open(const File& samplesFolder)
+{
+    {
+        const ScopedLock sl(lock);
+
+        if (samplesFolder == folder)
+            return;
+
+        if (dirty)
+            flush();
+
+        folder = samplesFolder;
+        indexFile = folder.getChildFile("samples.fsidx");
+        entries.clear();
+        quota = defaultQuota; // an index that records a quota replaces it
+
+        if (indexFile.existsAsFile())
+            loadIndex();
+        else
+            scanFolder();
+    }
+
+    // Until the upkeep thread has been through the folder, lookups move files
+    // they find at the top themselves
+    setMigrating(samplesFolder, true);
+    needsFlatScan = true;
+
+    if (!evictionThread.isThreadRunning())
+    {
+        evictionThread.addTimeSliceClient(this);
+        evictionThread.startThread();
+    }
+}
+
+File SampleStore::getFolder() const
+{
+    const ScopedLock sl(lock);
+    return folder;
+}
+
+File SampleStore::getFileFor(const String& freesoundId, const String& extension) const
+{
+    return getSampleFile(getFolder(), freesoundId, extension);
+}
+
+File SampleStore::getSampleFile(const File& folder, const String& freesoundId, const String& extension)
+{
+    // Create filename using just Freesound ID: FS_ID_XXXX.ogg
+    const String fileName = "FS_ID_" + freesoundId + extension;
+    const String digits = freesoundId.paddedLeft('0', 4);
+    const int length = digits.length();
+
+    const File file = folder.getChildFile(digits.substring(length - 2))
+                            .getChildFile(digits.substring(length - 4, length - 2))
+                            .getChildFile(fileName);
+
+    if (isMigrating(folder) && !file.exists())
+    {
+        // Not migrated yet: move it now rather than report it missing
+        const File flatFile = folder.getChildFile(fileName);
+
+        if (flatFile.existsAsFile() && file.getParentDirectory().createDirectory())
+            flatFile.moveFileTo(file);
+    }
+
+    return file;
+}
+
+bool SampleStore::contains(const String& freesoundId) const
+{
+    const ScopedLock sl(lock);
+    const auto key = toKey(freesoundId);
+    return entries.contains(key) && entries[key].state == State::Complete;
+}
+
+bool SampleStore::getEntry(const String& freesoundId, Entry& result) const
+{
+    const ScopedLock sl(lock);
+    const auto key = toKey(freesoundId);
+
+    if (!entries.contains(key))
+        return false;
+
+    result = entries[key];
+    return true;
+}
+
+int SampleStore::getNumEntries() const
+{
+    const ScopedLock sl(lock);
+    return entries.size();
+}
+
+void SampleStore::addCompletedFile(const String& freesoundId, const File& audioFile)
+{
+    Entry entry;
+    entry.freesoundId = toKey(freesoundId);
+    entry.sizeInBytes = audioFile.getSize();
+    entry.contentHash = hashFile(audioFile);
+    entry.lastAccessTime = Time::currentTimeMillis();
+    entry.state = State::Complete;
+
+    if (std::unique_ptr<AudioFormatReader> reader { formatManager.createReaderFor(audioFile) })
+    {
+        entry.sampleRate = reader->sampleRate;
+        entry.lengthInSamples = reader->lengthInSamples;
+    }
+
+    const ScopedLock sl(lock);
+    entries.set(entry.freesoundId, entry);
+    markDirty();
+}
+
+void SampleStore::markPartial(const String& freesoundId)
+{
+    const ScopedLock sl(lock);
+    const auto key = toKey(freesoundId);
+
+    Entry entry = entries.contains(key) ? entries[key] : Entry();
+    entry.freesoundId = key;
+    entry.state = State::Partial;
+    entries.set(key, entry);
+    markDirty();
+}
+
+void SampleStore::remove(const String& freesoundId)
+{
+    const ScopedLock sl(lock);
+    entries.remove(toKey(freesoundId));
+    markDirty();
+}
+
+void SampleStore::touch(const String& freesoundId)
+{
+    const ScopedLock sl(lock);
+    const auto key = toKey(freesoundId);
+
+    if (!entries.contains(key))
+        return;
+
+    auto entry = entries[key];
+    entry.lastAccessTime = Time::currentTimeMillis();
+    entries.set(key, entry);
+    markDirty();
+}
+
+bool SampleStore::verify(const String& freesoundId)
+{
+    Entry entry;
+
+    if (!getEntry(freesoundId, entry) || entry.state != State::Complete)
+        return false;
+
+    const File file = getFileFor(freesoundId);
+    bool ok = file.getSize() == entry.sizeInBytes;
+
+    if (ok)
+    {
+        const auto hash = hashFile(file);
+
+        // Files found by the first scan have no hash yet: this one becomes it
+        ok = entry.contentHash == 0 || hash == entry.contentHash;
+        entry.contentHash = hash;
+    }
+
+    if (!ok)
+        entry.state = State::Corrupt;
+
+    const ScopedLock sl(lock);
+    entries.set(entry.freesoundId, entry);
+    markDirty();
+    return ok;
+}
+
+void SampleStore::setQuota(int64 bytes)
+{
+    {
+        const ScopedLock sl(lock);
+
+        if (bytes == quota)
+            return;
+
+        quota = jmax((int64)0, bytes);
+        markDirty();
+    }
+
+    // Check straight away rather than at the next idle poll
+    evictionThread.moveToFrontOfQueue(this);
+}
+
+int64 SampleStore::getQuota() const
+{
+    const ScopedLock sl(lock);
+    return quota;
+}
+
+int64 SampleStore::getTotalBytes() const
+{
+    const ScopedLock sl(lock);
+    int64 total = 0;
+
+    for (HashMap<int64, Entry>::Iterator i(entries); i.next();)
+        total += i.getValue().sizeInBytes;
+
+    return total;
+}
+
+void SampleStore::addPinProvider(void* owner, PinProvider provider)
+{
+    const ScopedLock sl(pinLock);
+    pinProviders[owner] = std::move(provider);
+}
+
+void SampleStore::removePinProvider(void* owner)
+{
+    // Also waits for a pass that's calling the provider right now
+    const ScopedLock sl(pinLock);
+    pinProviders.erase(owner);
+}
+
+bool SampleStore::collectPins(StringArray& pinnedIds)
+{
+    const ScopedLock sl(pinLock);
+
+    for (auto& provider : pinProviders)
+        if (!provider.second(pinnedIds))
+            return false;
+
+    return true;
+}
+
+bool SampleStore::migrateFlatFiles()
+{
+    // Eviction thread. Moves a batch of files from the top of the folder into
+    // their subfolders; returns true while there are more to do.
+    if (needsFlatScan.exchange(false))
+    {
+        migrationFolder = getFolder();
+        flatFiles = migrationFolder.findChildFiles(File::findFiles, false, "FS_ID_*");
+    }
+
+    for (int n = 0; n < maxMigrationsPerSlice && !flatFiles.isEmpty(); ++n)
+    {
+        const File flatFile = flatFiles.removeAndReturn(flatFiles.size() - 1);
+        const String fileName = flatFile.getFileName();
+
+        // FS_ID_1234.ogg, FS_ID_1234.wav, FS_ID_1234.ogg.part...
+        const String freesoundId = fileName.fromFirstOccurrenceOf("FS_ID_", false, false).upToFirstOccurrenceOf(".", false, false);
+
+        if (freesoundId.isEmpty() || !freesoundId.containsOnly("0123456789"))
+            continue;
+
+        const File file = getSampleFile(flatFile.getParentDirectory(), freesoundId, fileName.fromFirstOccurrenceOf(".", true, false));
+
+        if (!file.exists() && file.getParentDirectory().createDirectory())
+            flatFile.moveFileTo(file);
+    }
+
+    if (!flatFiles.isEmpty())
+        return true;
+
+    if (migrationFolder != File())
+    {
+        setMigrating(migrationFolder, false);
+        migrationFolder = File();
+    }
+
+    return false;
+}
+
+bool SampleStore::verifyUnhashedFiles()
+{
+    // Eviction thread. Files found by the first scan were never hashed; check
+    // a few per slice so a deleted or damaged one stops counting as present.
+    // Returns true while there are more to do.
+    StringArray ids;
+
+    {
+        const ScopedLock sl(lock);
+
+        for (HashMap<int64, Entry>::Iterator i(entries); i.next() && ids.size() <= maxVerificationsPerSlice;)
+            if (i.getValue().state == State::Complete && i.getValue().contentHash == 0)
+                ids.add(String(i.getKey()));
+    }
+
+    for (int n = 0; n < jmin(maxVerificationsPerSlice, ids.size()); ++n)
+        verify(ids[n]);
+
+    return ids.size() > maxVerificationsPerSlice;
+}
+
+int SampleStore::useTimeSlice()
+{
+    // Eviction thread. Each slice moves or deletes a handful of files, so a
+    // big migration or clean-up is spread out and never holds the lock for long.
+    if (migrateFlatFiles())
+        return 10;
+
+    if (verifyUnhashedFiles())
+        return 50;
+
+    const int64 totalBytes = getTotalBytes();
+    const int64 currentQuota = getQuota();
+
+    if (currentQuota <= 0 || (evictionQueue.isEmpty() && totalBytes <= currentQuota))
+    {
+        evictionQueue.clear();
+        return 5000;
+    }
+
+    if (evictionQueue.isEmpty())
+    {
+        StringArray pinnedIds;
+
+        if (!collectPins(pinnedIds))
+            return 30000;
+
+        std::unordered_set<int64> pinned;
+
+        for (const auto& id : pinnedIds)
+            pinned.insert(toKey(id));
+
+        const int64 newestAllowed = Time::currentTimeMillis() - minAgeBeforeEviction;
+
+        {
+            const ScopedLock sl(lock);
+
+            for (HashMap<int64, Entry>::Iterator i(entries); i.next();)
+            {
+                const auto& entry = i.getValue();
+
+                if (entry.lastAccessTime <= newestAllowed && pinned.count(entry.freesoundId) == 0)
+                    evictionQueue.add(entry);
+            }
+        }
+
+        std::sort(evictionQueue.begin(), evictionQueue.end(),
+                  [](const Entry& a, const Entry& b) { return a.lastAccessTime < b.lastAccessTime; });
+
+        evictionGoal = (int64)((double)currentQuota * evictionTarget);
+
+        // Everything left is pinned or in use: try again later
+        if (evictionQueue.isEmpty())
+            return 30000;
+    }
+
+    int64 remaining = totalBytes;
+
+    for (int n = 0; n < maxEvictionsPerSlice && !evictionQueue.isEmpty() && remaining > evictionGoal; ++n)
+    {
+        const auto entry = evictionQueue.removeAndReturn(0);
+        evict(entry);
+        remaining -= entry.sizeInBytes;
+    }
+
+    if (remaining <= evictionGoal)
+        evictionQueue.clear();
+
+    return evictionQueue.isEmpty() ? 5000 : 50;
+}
+
+void SampleStore::evict(const Entry& entry)
+{
+    const String freesoundId(entry.freesoundId);
+
+    {
+        // Skip anything used or re-downloaded since the queue was made
+        const ScopedLock sl(lock);
+
+        if (!entries.contains(entry.freesoundId) || entries[entry.freesoundId].lastAccessTime != entry.lastAccessTime)
+            return;
+
+        entries.remove(entry.freesoundId);
+        markDirty();
+    }
+
+    getFileFor(freesoundId).deleteFile();
+
+    // The .wav written next to it when the sample was dragged out
+    getFileFor(freesoundId, ".wav").deleteFile();
+}
+
+uint64 SampleStore::hashFile(const File& file)
+{
+    // 64-bit FNV-1a: not cryptographic, but plenty to tell a damaged or
+    // truncated file from the one that was downloaded
+    FileInputStream input(file);
+
+    if (!input.openedOk())
+        return 0;
+
+    uint64 hash = 14695981039346656037ull;
+    HeapBlock<uint8> buffer(65536);
+
+    for (;;)
+    {
+        const int numRead = input.read(buffer, 65536);
+
+        if (numRead <= 0)
+            break;
+
+        for (int i = 0; i < numRead; ++i)
+            hash = (hash ^ buffer[i]) * 1099511628211ull;
+    }
+
+    return hash == 0 ? 1 : hash;
+}
+
+void SampleStore::loadIndex()
+{
+    // Caller holds the lock
+    MemoryMappedFile mapped(indexFile, MemoryMappedFile::readOnly);
+    auto* data = static_cast<const uint8*>(mapped.getData());
+    const auto size = (int64)mapped.getSize();
+
+    const uint32 version = (data != nullptr && size >= headerSizeV1) ? ByteOrder::littleEndianInt(data + 4) : 0;
+    const int thisHeaderSize = version == 1 ? headerSizeV1 : headerSize;
+
+    if (data == nullptr || size < thisHeaderSize
+        || ByteOrder::littleEndianInt(data) != indexMagic
+        || (version != 1 && version != indexVersion)
+        || (int)ByteOrder::littleEndianInt(data + 8) != recordSize)
+    {
+        // Unreadable or from another version: start again from what's on disk
+        scanFolder();
+        return;
+    }
+
+    if (version >= 2)
+        quota = (int64)ByteOrder::littleEndianInt64(data + 16);
+
+    const int64 numRecords = jmin((int64)ByteOrder::littleEndianInt(data + 12), (size - thisHeaderSize) / recordSize);
+
+    for (int64 i = 0; i < numRecords; ++i)
+    {
+        const uint8* record = data + thisHeaderSize + i * recordSize;
+
+        Entry entry;
+        entry.freesoundId = (int64)ByteOrder::littleEndianInt64(record);
+        entry.sizeInBytes = (int64)ByteOrder::littleEndianInt64(record + 8);
+        entry.contentHash = ByteOrder::littleEndianInt64(record + 16);
+
+        const uint64 rateBits = ByteOrder::littleEndianInt64(record + 24);
+        std::memcpy(&entry.sampleRate, &rateBits, sizeof(double));
+
+        entry.lengthInSamples = (int64)ByteOrder::littleEndianInt64(record + 32);
+        entry.lastAccessTime = (int64)ByteOrder::littleEndianInt64(record + 40);
+        entry.state = (State)ByteOrder::littleEndianInt(record + 48);
+
+        entries.set(entry.freesoundId, entry);
+    }
+}
+
+void SampleStore::scanFolder()
+{
+    // Caller holds the lock. One pass over the folder and its subfolders, the
+    // only time the store looks at every file.
+    DirectoryIterator iter(folder, true, "FS_ID_*.ogg");
+
+    while (iter.next())
+    {
+        const String freesoundId = iter.getFile().getFileNameWithoutExtension().fromFirstOccurrenceOf("FS_ID_", false, false);
+
+        if (!freesoundId.containsOnly("0123456789") || freesoundId.isEmpty())
+            continue;
+
+        Entry entry;
+        entry.freesoundId = toKey(freesoundId);
+        entry.sizeInBytes = iter.getFileSize();
+        entry.lastAccessTime = iter.getModificationTime().toMilliseconds();
+        entry.state = State::Complete;
+        entries.set(entry.freesoundId, entry);
+    }
+
+    markDirty();
+}
+
+void SampleStore::markDirty()
+{
+    // Caller holds the lock. Bursts of changes (a whole kit downloading) end
+    // up in one write.
+    dirty = true;
+    startTimer(1000);
+}
+
+void SampleStore::timerCallback()
+{
+    stopTimer();
+    flush();
+}
+
+void SampleStore::flush()
+{
+    const ScopedLock sl(lock);
+
+    if (!dirty || indexFile == File())
+        return;
+
+    MemoryOutputStream out((size_t)(headerSize + entries.size() * recordSize));
+    out.writeInt((int)indexMagic);
+    out.writeInt((int)indexVersion);
+    out.writeInt(recordSize);
+    out.writeInt(entries.size());
+    out.writeInt64(quota);
+
+    for (HashMap<int64, Entry>::Iterator i(entries); i.next();)
+    {
+        const auto& entry = i.getValue();
+
+        uint64 rateBits;
+        std::memcpy(&rateBits, &entry.sampleRate, sizeof(double));
+
+        out.writeInt64(entry.freesoundId);
+        out.writeInt64(entry.sizeInBytes);
+        out.writeInt64((int64)entry.contentHash);
+        out.writeInt64((int64)rateBits);
+        out.writeInt64(entry.lengthInSamples);
+        out.writeInt64(entry.lastAccessTime);
+        out.writeInt((int)entry.state);
+        out.writeInt(0);
+    }
+
+    // Written beside the index and renamed over it, so it's replaced in one step
+    TemporaryFile temp(indexFile);
+
+    if (temp.getFile().replaceWithData(out.getData(), out.getDataSize()) && temp.overwriteTargetFileWithTemporary())
+        dirty = false;
+}
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    SampleStore.h
+    Created: Index of the downloaded samples folder, so presence checks and
+             integrity checks don't have to touch the files themselves
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+//==============================================================================
+// Hold one in a SharedResourcePointer<SampleStore> and open() it on the samples
+// folder. Every instance then shares one in-memory copy of the index.
+//
+// The index is a small binary file (samples.fsidx) of fixed-size records. It
+// is memory-mapped and read once when the store is opened. After that,
+// contains() and getEntry() are hash lookups. Changes are written back by a
+// timer, into a temporary file that then replaces the index in one rename, so
+// a crash leaves either the old index or the new one, never half of each.
+//
+// A folder without an index (from before the store existed) is scanned once.
+// The content hashes of scanned files are filled in by verify(), which the
+// upkeep thread runs on them a few at a time.
+//
+// Samples are spread over two levels of subfolders (see getSampleFile()).
+// Files left at the top of the folder by older versions are moved into place
+// by the upkeep thread after open(). Until it's done, a lookup that reaches
+// one of them first moves it on the spot.
+//
+// With a quota set, a low priority thread deletes the least recently used
+// files once the folder goes over it, a few per time slice, until it is back
+// under. Files a pin provider names (presets, bookmarks, loaded pads) and
+// files used in the last few minutes are never deleted.
+//
+// All methods are thread-safe.
+//==============================================================================
+class SampleStore : private Timer,
+                    private TimeSliceClient
+{
+public:
+    enum class State : uint32
+    {
+        Missing,
+        Partial,    // a download was started, a .part file may be there
+        Complete,
+        Corrupt     // verify() found the wrong size or content
+    };
+
+    struct Entry
+    {
+        int64 freesoundId = 0;
+        int64 sizeInBytes = 0;
+        uint64 contentHash = 0;         // 0 until known
+        double sampleRate = 0.0;
+        int64 lengthInSamples = 0;
+        int64 lastAccessTime = 0;       // milliseconds since 1970
+        State state = State::Missing;
+    };
+
+    SampleStore();
+    ~SampleStore() override;
+
+    // Loads the folder's index. Does nothing if it's already open.
+    void open(const File& samplesFolder);
+    File getFolder() const;
+
+    // Where a sound's file lives in the store
+    File getFileFor(const String& freesoundId, const String& extension = ".ogg") const;
+
+    // Every sample path in the plugin comes from here. The two subfolders are
+    // named after the last four digits of the ID, which are evenly spread, so
+    // 100 x 100 folders keep each one small: 1234567 -> 67/45/FS_ID_1234567.ogg.
+    // Only works out the path, except while the folder is still being migrated,
+    // when a file still at the top is moved into place first. Use contains()
+    // to ask whether it's there.
+    // Doesn't create the subfolders, writers do that.
+    static File getSampleFile(const File& folder, const String& freesoundId, const String& extension = ".ogg");
+
+    // True for sounds that downloaded completely and haven't failed a verify()
+    bool contains(const String& freesoundId) const;
+    bool getEntry(const String& freesoundId, Entry& result) const;
+    int getNumEntries() const;
+
+    // Records a finished download: size, content hash, sample rate and length
+    // are read from the file (the audio header only, nothing is decoded)
+    void addCompletedFile(const String& freesoundId, const File& audioFile);
+    void markPartial(const String& freesoundId);
+    void remove(const String& freesoundId);
+
+    // Notes that a sound was used just now, for eviction
+    void touch(const String& freesoundId);
+
+    // Checks the file against its recorded size and hash without decoding it.
+    // A mismatch marks the entry Corrupt and returns false.
+    bool verify(const String& freesoundId);
+
+    // Writes pending changes now instead of on the next timer tick
+    void flush();
+
+    // Most the folder may hold, in bytes, 0 for no limit. Kept in the index, so
+    // it's shared by every instance and survives restarts. Folders without one
+    // recorded get defaultQuota.
+    void setQuota(int64 bytes);
+    int64 getQuota() const;
+    int64 getTotalBytes() const;
+
+    static constexpr int64 defaultQuota = (int64)4 * 1024 * 1024 * 1024;
+
+    // Called on the eviction thread before each pass to add the IDs of sounds
+    // that must stay. Returning false (say a preset couldn't be read) skips
+    // the pass, since anything it would delete might be one of them.
+    using PinProvider = std::function<bool(StringArray& pinnedIds)>;
+    void addPinProvider(void* owner, PinProvider provider);
+    void removePinProvider(void* owner);
+
+    static uint64 hashFile(const File& file);
+
+private:
+    static constexpr uint32 indexMagic = 0x58495346; // "FSIX"
+    static constexpr uint32 indexVersion = 2;
+
+    // Eviction stops once the folder is this far under the quota, so a full
+    // folder isn't trimmed again on every download
+    static constexpr double evictionTarget = 0.9;
+    static constexpr int64 minAgeBeforeEviction = 10 * 60 * 1000;
+    static constexpr int maxEvictionsPerSlice = 8;
+
+    static int64 toKey(const String& freesoundId) { return freesoundId.getLargeIntValue(); }
+
+    void loadIndex();
+    void scanFolder();
+    void markDirty();
+    void timerCallback() override;
+
+    int useTimeSlice() override;
+    bool migrateFlatFiles();
+    bool verifyUnhashedFiles();
+    bool collectPins(StringArray& pinnedIds);
+    void evict(const Entry& entry);
+
+    static constexpr int maxMigrationsPerSlice = 64;
+    static constexpr int maxVerificationsPerSlice = 4;
+
+    mutable CriticalSection lock;
+    File folder, indexFile;
+    HashMap<int64, Entry> entries;
+    int64 quota = 0;
+    bool dirty = false;
+
+    CriticalSection pinLock;
+    std::map<void*, PinProvider> pinProviders;
+
+    std::atomic<bool> needsFlatScan { false };
+
+    // Eviction thread only
+    Array<File> flatFiles;          // still to be moved into subfolders
+    File migrationFolder;           // the folder they're in
+    Array<Entry> evictionQueue;     // oldest first
+    int64 evictionGoal = 0;
+
+    TimeSliceThread evictionThread { "Sample store upkeep" };
+
+    AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStore)
+};
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    SincResampler.cpp
+    Created: Offline Kaiser-windowed sinc resampler used when pads are
+             converted to the host sample rate at load time
+
+  ==============================================================================
+*/
+
+#include "SincResampler.h"
+
+namespace
+{
+    constexpr int tableOversampling = 512; // kernel entries per source frame
+    constexpr double kaiserBeta = 9.0;     // roughly 90 dB stopband
+    constexpr double rolloff = 0.95;       // cutoff as a fraction of the lower Nyquist frequency
+
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 50; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+
+    struct KernelTable
+    {
+        KernelTable()
+        {
+            const int size = SincResampler::numZeroCrossings * tableOversampling + 2;
+            const double normalisation = besselI0(kaiserBeta);
+
+            values.resize((size_t)size);
+
+            for (int i = 0; i < size; ++i)
+            {
+                const double x = (double)i / tableOversampling;
+                const double ratio = x / SincResampler::numZeroCrossings;
+
+                const double window = ratio < 1.0 ? besselI0(kaiserBeta * std::sqrt(1.0 - ratio * ratio)) / normalisation
+                                                  : 0.0;
+                const double sinc = i == 0 ? 1.0 : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+
+                values[(size_t)i] = (float)(sinc * window);
+            }
+        }
+
+        std::vector<float> values;
+    };
+}
+
+float SincResampler::kernel(double x)
+{
+    static const KernelTable table;
+
+    const double position = std::abs(x) * tableOversampling;
+    const int index = (int)position;
+
+    if (index >= numZeroCrossings * tableOversampling)
+        return 0.0f;
+
+    const float alpha = (float)(position - index);
+    const float a = table.values[(size_t)index];
+    const float b = table.values[(size_t)index + 1];
+
+    return a + alpha * (b - a);
+}
+
+AudioBuffer<float> SincResampler::process(const AudioBuffer<float>& source, int numSourceFrames,
+                                          double sourceRate, double targetRate,
+                                          int paddingFrames, int& numOutputFrames)
+{
+    jassert(sourceRate > 0.0 && targetRate > 0.0);
+    jassert(numSourceFrames <= source.getNumSamples());
+
+    const double step = sourceRate / targetRate; // source frames per output frame
+    const int numChannels = source.getNumChannels();
+
+    numOutputFrames = (int)std::floor((double)numSourceFrames / step);
+
+    AudioBuffer<float> result(numChannels, numOutputFrames + paddingFrames);
+    result.clear();
+
+    // Below the target's Nyquist when downsampling, below the source's otherwise
+    const double cutoff = jmin(1.0, targetRate / sourceRate) * rolloff;
+    const double halfWidth = numZeroCrossings / cutoff;
+
+    std::vector<float> weights((size_t)std::ceil(2.0 * halfWidth) + 2);
+
+    for (int n = 0; n < numOutputFrames; ++n)
+    {
+        const double centre = n * step;
+        const int first = jmax(0, (int)std::ceil(centre - halfWidth));
+        const int last = jmin(numSourceFrames - 1, (int)std::floor(centre + halfWidth));
+        const int numTaps = last - first + 1;
+
+        if (numTaps <= 0)
+            continue;
+
+        for (int i = 0; i < numTaps; ++i)
+            weights[(size_t)i] = (float)cutoff * kernel(((first + i) - centre) * cutoff);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* in = source.getReadPointer(channel, first);
+            float sum = 0.0f;
+
+            for (int i = 0; i < numTaps; ++i)
+                sum += in[i] * weights[(size_t)i];
+
+            result.setSample(channel, n, sum);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    SincResampler.h
+    Created: Offline Kaiser-windowed sinc resampler used when pads are
+             converted to the host sample rate at load time
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+using namespace juce;
+
+//==============================================================================
+// Band-limited sample rate conversion for whole buffers. Far too slow for the
+// audio thread; meant for worker threads that prepare pad audio up front.
+//
+// Each output frame is a windowed-sinc weighted sum of the source frames
+// within numZeroCrossings of it (wider when downsampling, where the cutoff is
+// lowered to the target's Nyquist frequency).
+//==============================================================================
+class SincResampler
+{
+public:
+    static constexpr int numZeroCrossings = 32;
+
+    // Resamples the first numSourceFrames of every channel in source. The result
+    // holds numOutputFrames frames followed by paddingFrames of silence.
+    static AudioBuffer<float> process(const AudioBuffer<float>& source, int numSourceFrames,
+                                      double sourceRate, double targetRate,
+                                      int paddingFrames, int& numOutputFrames);
+
+private:
+    SincResampler() = delete;
+
+    // Windowed sinc at x source frames from the centre, for a cutoff of 1
+    static float kernel(double x);
+};